@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/authority_checker.hpp>
+#include <eos/chain/config.hpp>
+
+#include <fc/scoped_exit.hpp>
+
+#include <limits>
+
+namespace eos { namespace chain {
+
+const resolved_permission* permission_cache::get(const chainbase::database& db,
+                                                 const types::AccountPermission& level) {
+   auto itr = _permissions.find(level);
+   if (itr != _permissions.end()) {
+      ++_hits;
+      return itr->second.get();
+   }
+   ++_misses;
+
+   std::unique_ptr<resolved_permission> resolved;
+   if (auto permission = db.find<permission_object, by_owner>(boost::make_tuple(level.account, level.permission))) {
+      resolved.reset(new resolved_permission{permission->owner, permission->name, {}, {}});
+      resolved->auth.threshold = permission->auth.threshold;
+      resolved->auth.keys.assign(permission->auth.keys.begin(), permission->auth.keys.end());
+      resolved->auth.accounts.assign(permission->auth.accounts.begin(), permission->auth.accounts.end());
+
+      // Owner permissions have parent 0, which is the ID of some permission, but not one of the same account
+      if (permission->parent != permission->id) {
+         auto parent = db.find<permission_object, by_id>(permission->parent);
+         if (parent && parent->owner == permission->owner)
+            resolved->parent = parent->name;
+      }
+   }
+
+   auto result = resolved.get();
+   _permissions.emplace(level, std::move(resolved));
+   return result;
+}
+
+bool authority_checker::satisfied(const types::AccountPermission& level, uint32_t depth) {
+   uint32_t lowest_reached = std::numeric_limits<uint32_t>::max();
+   return check(level, depth, lowest_reached);
+}
+
+bool authority_checker::satisfied(const types::Authority& auth, uint32_t depth) {
+   uint32_t lowest_reached = std::numeric_limits<uint32_t>::max();
+   return check(auth, depth, lowest_reached);
+}
+
+bool authority_checker::check(const types::AccountPermission& level, uint32_t depth, uint32_t& lowest_reached) {
+   auto active = _in_progress.find(level);
+   if (active != _in_progress.end()) {
+      // Reached again through its own authority, which does not count towards it
+      lowest_reached = std::min(lowest_reached, active->second);
+      return false;
+   }
+   auto itr = _results.find(std::make_pair(level, depth));
+   if (itr != _results.end())
+      return itr->second;
+
+   const uint32_t position = _in_progress.size();
+   _in_progress.emplace(level, position);
+   auto done = fc::make_scoped_exit([this, &level] { _in_progress.erase(level); });
+
+   uint32_t reached = position;
+   bool result = false;
+   if (auto permission = _permissions.get(_db, level)) {
+      result = check(permission->auth, depth, reached);
+      if (!result && permission->parent)
+         result = check(types::AccountPermission{level.account, *permission->parent}, depth, reached);
+   }
+
+   // A result which counted an enclosing, undecided permission as unsatisfied only holds within that permission
+   if (reached >= position)
+      _results.emplace(std::make_pair(level, depth), result);
+   lowest_reached = std::min(lowest_reached, reached);
+   return result;
+}
+
+bool authority_checker::check(const types::Authority& auth, uint32_t depth, uint32_t& lowest_reached) {
+   uint32_t weight = 0;
+   for (const auto& key : auth.keys) {
+      if (weight >= auth.threshold)
+         return true;
+      if (_keys.count(key.key))
+         weight += uint32_t(key.weight);
+   }
+   if (depth < config::MaxAuthorityDepth) {
+      for (const auto& account : auth.accounts) {
+         if (weight >= auth.threshold)
+            return true;
+         if (check(account.permission, depth + 1, lowest_reached))
+            weight += uint32_t(account.weight);
+      }
+   }
+   return weight >= auth.threshold;
+}
+
+} } // eos::chain
@@ -1,7 +1,11 @@
 #include <eos/chain/block_log.hpp>
 #include <fstream>
+#include <mutex>
 #include <fc/io/raw.hpp>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #define LOG_READ  (std::ios::in | std::ios::binary)
 #define LOG_WRITE (std::ios::out | std::ios::binary | std::ios::app)
 
@@ -18,6 +22,8 @@ namespace eos { namespace chain {
             fc::path                 index_file;
             bool                     block_write;
             bool                     index_write;
+            /// Guards everything above, so that one thread may append while others read
+            std::recursive_mutex     mutex;
 
             inline void check_block_read() {
                if (block_write) {
@@ -151,6 +157,7 @@ namespace eos { namespace chain {
    }
 
    uint64_t block_log::append(const signed_block& b) {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       try {
          my->check_block_write();
          my->check_index_write();
@@ -173,11 +180,26 @@ namespace eos { namespace chain {
    }
 
    void block_log::flush() {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       my->block_stream.flush();
       my->index_stream.flush();
    }
 
+   void block_log::sync() {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
+      flush();
+      // The streams give no access to their descriptors, but syncing any descriptor of a file syncs the file
+      for (const auto& file : {my->block_file, my->index_file}) {
+         int fd = ::open(file.generic_string().c_str(), O_RDONLY);
+         FC_ASSERT(fd >= 0, "Unable to open ${f} to sync it", ("f", file.generic_string()));
+         int result = ::fsync(fd);
+         ::close(fd);
+         FC_ASSERT(result == 0, "Unable to sync ${f}", ("f", file.generic_string()));
+      }
+   }
+
    std::pair<signed_block, uint64_t> block_log::read_block(uint64_t pos)const {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       my->check_block_read();
 
       my->block_stream.seekg(pos);
@@ -188,6 +210,7 @@ namespace eos { namespace chain {
    }
 
    optional<signed_block> block_log::read_block_by_num(uint32_t block_num)const {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       try {
          optional<signed_block> b;
          uint64_t pos = get_block_pos(block_num);
@@ -201,6 +224,7 @@ namespace eos { namespace chain {
    }
 
    uint64_t block_log::get_block_pos(uint32_t block_num) const {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       my->check_index_read();
 
       if (!(my->head.valid() && block_num <= block_header::num_from_id(my->head_id) && block_num > 0))
@@ -212,6 +236,7 @@ namespace eos { namespace chain {
    }
 
    optional<signed_block> block_log::read_head()const {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       my->check_block_read();
 
       uint64_t pos;
@@ -226,7 +251,34 @@ namespace eos { namespace chain {
       return read_block(pos).first;
    }
 
-   const optional<signed_block>& block_log::head()const {
+   block_log::reader block_log::read_blocks_from(uint32_t block_num)const {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
+      // Appends are buffered; make sure the reader sees everything written so far
+      my->block_stream.flush();
+      return reader(my->block_file, get_block_pos(block_num));
+   }
+
+   block_log::reader::reader(const fc::path& block_file, uint64_t pos)
+   :_pos(pos), _end_pos(fc::file_size(block_file)) {
+      _stream.exceptions(std::fstream::failbit | std::fstream::badbit);
+      _stream.open(block_file.generic_string().c_str(), LOG_READ);
+      if (_pos < _end_pos)
+         _stream.seekg(_pos);
+   }
+
+   optional<signed_block> block_log::reader::next() {
+      if (_pos >= _end_pos)
+         return {};
+      optional<signed_block> b = signed_block();
+      fc::raw::unpack(_stream, *b);
+      // Skip the position which trails each block
+      _stream.seekg(sizeof(uint64_t), std::ios::cur);
+      _pos = _stream.tellg();
+      return b;
+   }
+
+   optional<signed_block> block_log::head()const {
+      std::lock_guard<std::recursive_mutex> lock(my->mutex);
       return my->head;
    }
 
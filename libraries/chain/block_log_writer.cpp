@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/block_log_writer.hpp>
+#include <eos/chain/config.hpp>
+
+#include <fc/log/logger.hpp>
+
+namespace eos { namespace chain {
+
+block_log_writer::block_log_writer(block_log& log, uint32_t sync_interval)
+   : _log(log), _queue(config::BlockLogQueueSize), _sync_interval(sync_interval) {
+   auto head = _log.head();
+   _last_queued = head? head->block_num() : 0;
+   _last_written = _last_queued;
+   _last_durable = _last_queued;
+   _thread = std::thread([this] { run(); });
+}
+
+block_log_writer::~block_log_writer() {
+   resume();
+   _queue.close();
+   _thread.join();
+   try {
+      if (_last_durable < _last_written) {
+         _log.sync();
+         _last_durable = _last_written.load();
+      }
+   } catch (const fc::exception& e) {
+      elog("Unable to sync the block log: ${e}", ("e", e.to_detail_string()));
+   }
+}
+
+void block_log_writer::append(signed_block b) {
+   rethrow_error();
+   auto num = b.block_num();
+   FC_ASSERT(num == _last_queued + 1, "Blocks must be appended to the block log in order",
+             ("block_num", num)("last_queued", _last_queued));
+   FC_ASSERT(_queue.push(std::move(b)), "The block log writer has stopped");
+   _last_queued = num;
+}
+
+void block_log_writer::wait() {
+   {
+      std::unique_lock<std::mutex> lock(_mutex);
+      FC_ASSERT(!_paused, "Cannot wait for a paused block log writer");
+      _written.wait(lock, [this] { return _error || _last_written == _last_queued; });
+   }
+   rethrow_error();
+   // Nothing is queued, so the writer thread is idle until the next append
+   if (_last_durable < _last_written) {
+      if (_sync_interval > 0)
+         _log.sync();
+      _last_durable = _last_written.load();
+   }
+}
+
+void block_log_writer::pause() {
+   std::lock_guard<std::mutex> lock(_mutex);
+   _paused = true;
+}
+
+void block_log_writer::resume() {
+   std::lock_guard<std::mutex> lock(_mutex);
+   _paused = false;
+   _resumed.notify_all();
+}
+
+void block_log_writer::rethrow_error() {
+   std::lock_guard<std::mutex> lock(_mutex);
+   if (_error)
+      std::rethrow_exception(_error);
+}
+
+void block_log_writer::run() {
+   uint32_t unsynced = 0;
+   try {
+      while (auto block = _queue.pop()) {
+         {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _resumed.wait(lock, [this] { return !_paused; });
+         }
+         // Take whatever else is queued already into the batch; this thread is the only one popping
+         uint32_t last = block->block_num();
+         _log.append(*block);
+         for (size_t queued = _queue.size(); queued > 0; --queued) {
+            block = _queue.pop();
+            last = block->block_num();
+            _log.append(*block);
+         }
+         unsynced += last - _last_written;
+
+         auto interval = _sync_interval.load();
+         if (interval > 0 && unsynced >= interval) {
+            _log.sync();
+            unsynced = 0;
+            _last_durable = last;
+         } else {
+            _log.flush();
+            if (interval == 0)
+               _last_durable = last;
+         }
+
+         std::lock_guard<std::mutex> lock(_mutex);
+         _last_written = last;
+         _written.notify_all();
+      }
+   } catch (...) {
+      elog("Writing to the block log failed; no further blocks will be written");
+      std::lock_guard<std::mutex> lock(_mutex);
+      _error = std::current_exception();
+      _written.notify_all();
+      _queue.close();
+   }
+}
+
+} } // eos::chain
@@ -24,12 +24,14 @@
 
 #include <eos/chain/chain_controller.hpp>
 #include <eos/chain/exceptions.hpp>
+#include <eos/chain/bounded_queue.hpp>
 
 #include <eos/chain/block_summary_object.hpp>
 #include <eos/chain/global_property_object.hpp>
 #include <eos/chain/key_value_object.hpp>
 #include <eos/chain/action_objects.hpp>
 #include <eos/chain/transaction_object.hpp>
+#include <eos/chain/generated_transaction_object.hpp>
 #include <eos/chain/producer_object.hpp>
 
 #include <eos/chain/wasm_interface.hpp>
@@ -37,6 +39,7 @@
 #include <eos/types/native.hpp>
 #include <eos/types/generated.hpp>
 
+#include <eos/utilities/metrics.hpp>
 #include <eos/utilities/randutils.hpp>
 #include <eos/utilities/pcg-random/pcg_random.hpp>
 
@@ -57,6 +60,38 @@
 
 namespace eos { namespace chain {
 
+namespace {
+   /// The stages of block and transaction processing whose latencies are tracked, in microseconds
+   struct chain_metrics {
+      utilities::metrics_registry& registry = utilities::metrics_registry::get();
+
+      utilities::histogram& push_block = registry.get_histogram(
+         "eos_chain_push_block_us", "Time to push a block, including switching forks");
+      utilities::histogram& apply_block = registry.get_histogram(
+         "eos_chain_apply_block_us", "Time to apply a block");
+      utilities::histogram& apply_transaction = registry.get_histogram(
+         "eos_chain_apply_transaction_us", "Time to apply a transaction, including its validation");
+      utilities::histogram& validate_transaction = registry.get_histogram(
+         "eos_chain_validate_transaction_us", "Time to validate a transaction");
+      utilities::histogram& process_message = registry.get_histogram(
+         "eos_chain_process_message_us", "Time to process a message, including its notifications");
+      utilities::histogram& update_last_irreversible_block = registry.get_histogram(
+         "eos_chain_update_last_irreversible_block_us", "Time to advance the last irreversible block");
+
+      utilities::counter& blocks_applied = registry.get_counter(
+         "eos_chain_blocks_applied_total", "Blocks applied, including those later popped");
+      utilities::counter& transactions_applied = registry.get_counter(
+         "eos_chain_transactions_applied_total", "Transactions applied, including pending ones applied again");
+      utilities::counter& messages_processed = registry.get_counter(
+         "eos_chain_messages_processed_total", "Messages processed");
+   };
+
+   chain_metrics& metrics() {
+      static chain_metrics m;
+      return m;
+   }
+}
+
 
 String apply_context::get( String key )const {
    const auto& obj = db.get<key_value_object,by_scope_key>( boost::make_tuple(scope, key) );
@@ -97,6 +132,8 @@ bool chain_controller::is_known_block(const block_id_type& id)const
  */
 bool chain_controller::is_known_transaction(const transaction_id_type& id)const
 {
+   if (!_known_transactions.may_contain(id))
+      return false;
    const auto& trx_idx = _db.get_index<transaction_multi_index, by_trx_id>();
    return trx_idx.find( id ) != trx_idx.end();
 }
@@ -123,6 +160,14 @@ optional<signed_block> chain_controller::fetch_block_by_number(uint32_t num)cons
 
    // Not in _block_log, so it must be since the last irreversible block. Grab it from _fork_db instead
    if (num <= head_block_num()) {
+      if (!_branch_block_ids.empty()) {
+         auto first = block_header::num_from_id(_branch_block_ids.front());
+         if (num >= first && num - first < _branch_block_ids.size())
+            if (auto block = _fork_db.fetch_block(_branch_block_ids[num - first]))
+               return block->data;
+      }
+
+      // The block was applied without going through the fork database, or before the node started
       auto block = _fork_db.head();
       while (block && block->num > num)
          block = block->prev.lock();
@@ -133,12 +178,13 @@ optional<signed_block> chain_controller::fetch_block_by_number(uint32_t num)cons
    return optional<signed_block>();
 }
 
-const SignedTransaction& chain_controller::get_recent_transaction(const transaction_id_type& trx_id) const
+SignedTransaction chain_controller::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = _db.get_index<transaction_multi_index, by_trx_id>();
    auto itr = index.find(trx_id);
    FC_ASSERT(itr != index.end());
-   return itr->trx;
+   FC_ASSERT(!itr->packed_trx.empty(), "Transaction bodies are not being stored", ("id", trx_id));
+   return fc::raw::unpack<SignedTransaction>(vector<char>(itr->packed_trx.begin(), itr->packed_trx.end()));
 }
 
 std::vector<block_id_type> chain_controller::get_block_ids_on_fork(block_id_type head_of_fork) const
@@ -167,17 +213,107 @@ std::vector<block_id_type> chain_controller::get_block_ids_on_fork(block_id_type
  */
 bool chain_controller::push_block(const signed_block& new_block, uint32_t skip)
 { try {
+   if (!(skip & skip_transaction_signatures)) {
+      vector<const SignedTransaction*> trxs;
+      for (const auto& cycle : new_block.cycles)
+         for (const auto& thread : cycle)
+            for (const auto& trx : thread.user_input)
+               trxs.push_back(&trx);
+      recover_signature_keys(trxs);
+   }
+
    return with_skip_flags( skip, [&](){ 
       return without_pending_transactions( [&]() {
          return _db.with_write_lock( [&]() {
+            auto on_exit = fc::make_scoped_exit( [this](){ publish_head_block_state(); } );
+            return _push_block(new_block);
+         } );
+      });
+   });
+} FC_CAPTURE_AND_RETHROW((new_block)) }
+
+bool chain_controller::push_block(const signed_block& new_block, const block_prevalidation& checked, uint32_t skip)
+{ try {
+   return with_skip_flags( skip, [&](){
+      return without_pending_transactions( [&]() {
+         return _db.with_write_lock( [&]() {
+            _prevalidation = &checked;
+            auto on_exit = fc::make_scoped_exit( [this](){
+               _prevalidation = nullptr;
+               publish_head_block_state();
+            } );
             return _push_block(new_block);
          } );
       });
    });
 } FC_CAPTURE_AND_RETHROW((new_block)) }
 
+std::future<block_prevalidation> chain_controller::prevalidate_block(const signed_block& b, uint32_t skip)const {
+   return _thread_pool->post([this, &b, skip]() { return prevalidate(b, skip); });
+}
+
+block_prevalidation chain_controller::prevalidate(const signed_block& b, uint32_t skip)const {
+   block_prevalidation checked;
+   checked.id = b.id();
+   if (!(skip & skip_merkle_check))
+      checked.merkle_root = b.calculate_merkle_root();
+   if (!(skip & skip_producer_signature)) {
+      try {
+         checked.signee = b.signee();
+      } catch (const fc::exception&) {
+         // A bad signature is reported when the block header is validated
+      }
+   }
+   if (!(skip & skip_transaction_signatures)) {
+      for (const auto& cycle : b.cycles)
+         for (const auto& thread : cycle)
+            for (const auto& trx : thread.user_input) {
+               try {
+                  get_signature_keys(trx, trx.sig_digest(_chain_id));
+               } catch (const fc::exception&) {
+                  // Bad signatures are reported when the transaction is validated
+               }
+            }
+   }
+   // Blocks whose authorities are not checked, such as those replayed from the block log, are trusted, so their code
+   // starts compiling now, while the blocks before them are applied. Checking authorities needs the chain state.
+   if (skip & skip_authority_check) {
+      precompile_contracts(b, true);
+      checked.contracts_precompiled = true;
+   }
+   return checked;
+}
+
+vector<bool> chain_controller::push_blocks(const vector<signed_block>& blocks, uint32_t skip) {
+   // Enough blocks are kept in flight to keep every worker busy while the oldest of them is applied
+   const size_t window = _thread_pool->size() + 1;
+   deque<std::future<block_prevalidation>> in_flight;
+   size_t next = 0;
+   auto fill = [&]() {
+      while (next < blocks.size() && in_flight.size() < window)
+         in_flight.emplace_back(prevalidate_block(blocks[next++], skip));
+   };
+   // The workers refer to the blocks, so they must finish before we return, even if a block fails
+   auto on_exit = fc::make_scoped_exit( [&in_flight](){
+      for (auto& f : in_flight)
+         if (f.valid()) f.wait();
+   });
+
+   vector<bool> results;
+   results.reserve(blocks.size());
+   fill();
+   for (const auto& block : blocks) {
+      auto checked = in_flight.front().get();
+      in_flight.pop_front();
+      fill();
+      results.push_back(push_block(block, checked, skip));
+   }
+   return results;
+}
+
 bool chain_controller::_push_block(const signed_block& new_block)
 { try {
+   utilities::scoped_timer timer(metrics().push_block);
    uint32_t skip = _skip_flags;
    if (!(skip&skip_fork_db)) {
       /// TODO: if the block is greater than the head block and before the next maintenance interval
@@ -207,6 +343,7 @@ bool chain_controller::_push_block(const signed_block& new_block)
                 }
                 catch (const fc::exception& e) { except = e; }
                 if (except) {
+                   _permission_cache.clear();
                    wlog("exception thrown while switching forks ${e}", ("e",except->to_detail_string()));
                    // remove the rest of branches.first from the fork_db, those blocks are invalid
                    while (ritr != branches.first.rend()) {
@@ -240,6 +377,7 @@ bool chain_controller::_push_block(const signed_block& new_block)
       session.push();
    } catch ( const fc::exception& e ) {
       elog("Failed to push new block:\n${e}", ("e", e.to_detail_string()));
+      _permission_cache.clear();
       _fork_db.remove(new_block.id());
       throw;
    }
@@ -257,33 +395,146 @@ bool chain_controller::_push_block(const signed_block& new_block)
  * queues.
  */
 void chain_controller::push_transaction(const SignedTransaction& trx, uint32_t skip)
+{
+   push_transaction(transaction_metadata(trx), skip);
+}
+
+void chain_controller::push_transaction(const transaction_metadata& trx, uint32_t skip)
 { try {
+   if (!(skip & skip_transaction_signatures))
+      get_signature_keys(trx.trx(), trx.sig_digest(_chain_id));
+
    with_skip_flags(skip, [&]() {
       _db.with_write_lock([&]() {
          _push_transaction(trx);
       });
    });
-} FC_CAPTURE_AND_RETHROW((trx)) }
+} FC_CAPTURE_AND_RETHROW((trx.trx())) }
 
-void chain_controller::_push_transaction(const SignedTransaction& trx) {
+void chain_controller::_push_transaction(const transaction_metadata& trx) {
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
-   if (!_pending_tx_session.valid())
+   if (!_pending_tx_session.valid()) {
       _pending_tx_session = _db.start_undo_session(true);
+      _generated_transactions_at_head = !_db.get_index<generated_transaction_multi_index, by_expiration>().empty();
+   }
 
    auto temp_session = _db.start_undo_session(true);
-   _apply_transaction(trx);
+   auto execution_time = _apply_transaction(trx).cpu;
    _pending_transactions.push_back(trx);
+   update_candidate_block(trx, execution_time);
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.squash();
 
    // notify anyone listening to pending transactions
-   on_pending_transaction(trx);
+   on_pending_transaction(trx.trx());
 }
 
 
+static size_t max_block_header_size() {
+   static const size_t size = fc::raw::pack_size( signed_block_header() ) + 4;
+   return size;
+}
+
+void chain_controller::update_candidate_block(const transaction_metadata& trx, fc::microseconds execution_time) {
+   // If the pending transactions were rebuilt since the candidate was last extended, start a new candidate
+   if (!_candidate_block || _candidate_block->previous != head_block_id() ||
+       _candidate_block->transactions + 1 != _pending_transactions.size()) {
+      _candidate_block.reset(new candidate_block(head_block_id(), _thread_pool->size() + 1, max_block_header_size()));
+      _candidate_block->complete = _pending_transactions.size() == 1;
+   }
+
+   auto& candidate = *_candidate_block;
+   ++candidate.transactions;
+   if (!candidate.complete)
+      return;
+   // A transaction which would make the block too big is postponed, but its effects are in the pending state
+   if (candidate.size + trx.packed_size() >= get_global_properties().configuration.maxBlockSize) {
+      candidate.complete = false;
+      return;
+   }
+   // Likewise one which would take it over the execution budget, unless the block would otherwise be empty
+   if (_block_execution_budget.count() > 0 && candidate.transactions > 1 &&
+       candidate.execution_time + execution_time > _block_execution_budget) {
+      candidate.complete = false;
+      return;
+   }
+   candidate.size += trx.packed_size();
+   candidate.execution_time += execution_time;
+   candidate.scheduler.schedule(trx.trx());
+}
+
+bool chain_controller::candidate_block_ready()const {
+   // The pending state does not include the queued generated transactions, which a block applies first
+   return _candidate_block && _candidate_block->complete && _candidate_block->previous == head_block_id() &&
+          !_generated_transactions_at_head && _candidate_block->transactions == _pending_transactions.size() &&
+          _candidate_block->size < get_global_properties().configuration.maxBlockSize;
+}
+
+void chain_controller::restore_pending_transactions(const deque<transaction_metadata>& old_pending,
+                                                    const block_id_type& old_head) {
+   if (old_pending.empty())
+      return;
+
+   // Collect what the blocks applied since old_head included and wrote. If old_head is not an ancestor of the new head,
+   // we switched forks, and nothing about the pending transactions can be assumed.
+   bool extends_old_head = true;
+   // The scopes written by generated transactions are not known once they have been dequeued
+   bool applied_generated = false;
+   std::set<transaction_id_type> included;
+   flat_set<AccountName> written;
+   if (head_block_id() != old_head) {
+      auto old_head_num = block_header::num_from_id(old_head);
+      auto item = _fork_db.fetch_block(head_block_id());
+      while (item && item->num > old_head_num && item->id != old_head) {
+         for (const auto& cycle : item->data.cycles)
+            for (const auto& thread : cycle) {
+               applied_generated |= !thread.generated_input.empty();
+               for (const auto& trx : thread.user_input) {
+                  included.insert(trx.id());
+                  auto scope = trx.write_scope();
+                  written.insert(scope.begin(), scope.end());
+               }
+            }
+         item = item->prev.lock();
+      }
+      extends_old_head = item && item->id == old_head;
+   }
+
+   // Authorities are checked again: the new blocks may have changed permissions without touching these scopes
+   const uint32_t carry_over_skip = skip_validate | skip_transaction_signatures | skip_tapos_check;
+   uint32_t reapplied = 0, carried_over = 0;
+   for (const auto& trx : old_pending) {
+      try {
+         if (head_block_time() > trx.trx().expiration || included.count(trx.id()))
+            continue;
+
+         bool conflicts = !extends_old_head || applied_generated;
+         if (!conflicts && !written.empty()) {
+            auto reads = trx.trx().read_scope();
+            auto writes = trx.trx().write_scope();
+            auto touched = [&written](const AccountName& a) { return written.count(a) > 0; };
+            conflicts = std::any_of(reads.begin(), reads.end(), touched) ||
+                        std::any_of(writes.begin(), writes.end(), touched);
+         }
+
+         if (conflicts) {
+            push_transaction(trx);
+            ++reapplied;
+         } else {
+            push_transaction(trx, carry_over_skip);
+            ++carried_over;
+         }
+      } catch ( ... ){}
+   }
+
+   if (reapplied > 0)
+      dlog("Rebuilt pending state: ${c} transactions carried over, ${r} fully re-applied",
+           ("c", carried_over)("r", reapplied));
+}
+
 signed_block chain_controller::generate_block(
    fc::time_point_sec when,
    const AccountName& producer,
@@ -300,29 +551,10 @@ signed_block chain_controller::generate_block(
    });
 } FC_CAPTURE_AND_RETHROW( (when) ) }
 
-signed_block chain_controller::_generate_block(
-   fc::time_point_sec when,
-   const AccountName& producer,
-   const fc::ecc::private_key& block_signing_private_key
-   )
+block_schedule_stats chain_controller::apply_pending_transactions(vector<cycle>& cycles)
 {
-   try {
-   uint32_t skip = _skip_flags;
-   uint32_t slot_num = get_slot_at_time( when );
-   FC_ASSERT( slot_num > 0 );
-   AccountName scheduled_producer = get_scheduled_producer( slot_num );
-   FC_ASSERT( scheduled_producer == producer );
-
-   const auto& producer_obj = get_producer(scheduled_producer);
-
-   if( !(skip & skip_producer_signature) )
-      FC_ASSERT( producer_obj.signing_key == block_signing_private_key.get_public_key() );
-
-   static const size_t max_block_header_size = fc::raw::pack_size( signed_block_header() ) + 4;
    auto maximum_block_size = get_global_properties().configuration.maxBlockSize;
-   size_t total_block_size = max_block_header_size;
-
-   signed_block pending_block;
+   size_t total_block_size = max_block_header_size();
 
    //
    // The following code throws away existing pending_tx_session and
@@ -337,12 +569,47 @@ signed_block chain_controller::_generate_block(
    //
    _pending_tx_session.reset();
    _pending_tx_session = _db.start_undo_session(true);
+   _permission_cache.clear();
+
+   // Pack transactions into as many threads as this node could apply concurrently
+   transaction_scheduler scheduler(cycles, _thread_pool->size() + 1);
 
    uint64_t postponed_tx_count = 0;
+   uint64_t over_budget_tx_count = 0;
+   uint64_t included_tx_count = 0;
+   fc::microseconds block_execution_time;
+   bool budgeted = _block_execution_budget.count() > 0;
+
+   // Transactions generated by earlier blocks go first, earliest deadline first, in a cycle of their own. The block
+   // references them by ID, as every node holds them in its queue.
+   thread generated;
+   vector<generated_transaction_id_type> queued;
+   for (const auto& gtrx : _db.get_index<generated_transaction_multi_index, by_expiration>())
+      queued.push_back(gtrx.trx_id);
+   for (const auto& id : queued) {
+      if (total_block_size + sizeof(id) >= maximum_block_size ||
+          (budgeted && block_execution_time >= _block_execution_budget))
+         break;
+
+      try {
+         auto temp_session = _db.start_undo_session(true);
+         execution_timer timer;
+         apply_generated_transaction(id);
+         temp_session.squash();
+
+         block_execution_time += charged_cpu_time(timer.cpu());
+         total_block_size += sizeof(id);
+         generated.generated_input.push_back(id);
+      } catch (const fc::exception& e) {
+         // The transaction stays queued until it is included or expires
+         wlog("Generated transaction ${id} was not processed while generating block due to ${e}", ("id", id)("e", e));
+      }
+   }
+
    // pop pending state (reset to head block state)
-   for( const SignedTransaction& tx : _pending_transactions )
+   for( const transaction_metadata& tx : _pending_transactions )
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      size_t new_total_size = total_block_size + tx.packed_size();
 
       // postpone transaction if it would make block too big
       if( new_total_size >= maximum_block_size )
@@ -351,33 +618,91 @@ signed_block chain_controller::_generate_block(
          continue;
       }
 
+      // postpone transaction if the block has used up its execution budget
+      if( budgeted && block_execution_time >= _block_execution_budget )
+      {
+         over_budget_tx_count++;
+         continue;
+      }
+
       try
       {
          auto temp_session = _db.start_undo_session(true);
-         _apply_transaction(tx);
-         temp_session.squash();
+         auto execution_time = _apply_transaction(tx).cpu;
 
-         total_block_size += fc::raw::pack_size(tx);
-         if (pending_block.cycles.empty()) {
-            pending_block.cycles.resize(1);
-            pending_block.cycles.back().resize(1);
+         // postpone transaction if it took the block over budget; its changes are undone with temp_session
+         if( budgeted && included_tx_count > 0 && block_execution_time + execution_time > _block_execution_budget )
+         {
+            over_budget_tx_count++;
+            continue;
          }
-         pending_block.cycles.back().back().user_input.emplace_back(tx);
-#warning TODO: Populate generated blocks with generated transactions
+         temp_session.squash();
+
+         ++included_tx_count;
+         block_execution_time += execution_time;
+         total_block_size += tx.packed_size();
+         scheduler.schedule(tx.trx());
       }
       catch ( const fc::exception& e )
       {
          // Do nothing, transaction will not be re-applied
          wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
-         wlog( "The transaction was ${t}", ("t", tx) );
+         wlog( "The transaction was ${t}", ("t", tx.trx()) );
       }
    }
    if( postponed_tx_count > 0 )
    {
       wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
    }
+   if( over_budget_tx_count > 0 )
+   {
+      wlog( "Postponed ${n} transactions due to block execution budget of ${b} us",
+            ("n", over_budget_tx_count)("b", _block_execution_budget.count()) );
+   }
+   if( !generated.generated_input.empty() )
+   {
+      cycles.emplace(cycles.begin());
+      cycles.front().push_back(std::move(generated));
+   }
+
+   return scheduler.stats();
+}
+
+signed_block chain_controller::_generate_block(
+   fc::time_point_sec when,
+   const AccountName& producer,
+   const fc::ecc::private_key& block_signing_private_key
+   )
+{
+   try {
+   uint32_t skip = _skip_flags;
+   uint32_t slot_num = get_slot_at_time( when );
+   FC_ASSERT( slot_num > 0 );
+   AccountName scheduled_producer = get_scheduled_producer( slot_num );
+   FC_ASSERT( scheduled_producer == producer );
+
+   const auto& producer_obj = get_producer(scheduled_producer);
+
+   if( !(skip & skip_producer_signature) )
+      FC_ASSERT( producer_obj.signing_key == block_signing_private_key.get_public_key() );
+
+   signed_block pending_block;
+
+   if (candidate_block_ready()) {
+      // Every pending transaction has already been applied, in order, to the pending state, and scheduled into the
+      // candidate block as it arrived; the block is ready but for its header.
+      pending_block.cycles = std::move(_candidate_block->cycles);
+      _last_schedule_stats = _candidate_block->scheduler.stats();
+   } else {
+      _last_schedule_stats = apply_pending_transactions(pending_block.cycles);
+   }
+   if( _last_schedule_stats.transactions > 0 )
+      dlog( "Block schedule: ${s}", ("s", _last_schedule_stats) );
+
+   _candidate_block.reset();
 
    _pending_tx_session.reset();
+   _permission_cache.clear();
 
    // We have temporarily broken the invariant that
    // _pending_tx_session is the result of applying _pending_tx, as
@@ -425,12 +750,17 @@ void chain_controller::pop_block()
 
    _fork_db.pop_block();
    _db.undo();
+   _permission_cache.clear();
+   truncate_branch_block_ids(head_block_num());
+   publish_head_block_state();
 } FC_CAPTURE_AND_RETHROW() }
 
 void chain_controller::clear_pending()
 { try {
    _pending_transactions.clear();
    _pending_tx_session.reset();
+   _candidate_block.reset();
+   _permission_cache.clear();
 } FC_CAPTURE_AND_RETHROW() }
 
 //////////////////// private methods ////////////////////
@@ -452,14 +782,31 @@ void chain_controller::apply_block(const signed_block& next_block, uint32_t skip
 
 void chain_controller::_apply_block(const signed_block& next_block)
 { try {
+   utilities::scoped_timer timer(metrics().apply_block);
+   metrics().blocks_applied.add();
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = _skip_flags;
 
-   FC_ASSERT((skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(),
-             "", ("next_block.transaction_merkle_root", next_block.transaction_merkle_root)
-             ("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()));
+   // Use the context-free checks done by prevalidate_block, if they were done for this block
+   const block_prevalidation* checked = nullptr;
+   if (_prevalidation && _prevalidation->id == next_block.id())
+      checked = _prevalidation;
+
+   if (!(skip & skip_merkle_check)) {
+      auto merkle_root = (checked && checked->merkle_root)? *checked->merkle_root : next_block.calculate_merkle_root();
+      FC_ASSERT(next_block.transaction_merkle_root == merkle_root,
+                "", ("next_block.transaction_merkle_root", next_block.transaction_merkle_root)
+                ("calc",merkle_root)("next_block",next_block)("id",next_block.id()));
+   }
+
+   const producer_object& signing_producer = validate_block_header(skip, next_block,
+                                                                   checked? checked->signee : optional<public_key_type>());
 
-   const producer_object& signing_producer = validate_block_header(skip, next_block);
+   // Start compiling the code the block sets, so that it compiles while the transactions before it are applied.
+   // Authorities are checked against the state before the block; a transaction which fails that check only has its
+   // code compiled when the code is loaded.
+   if (!(checked && checked->contracts_precompiled))
+      precompile_contracts(next_block, !should_check_authorization());
 
    /* We do not need to push the undo state for each transaction
     * because they either all apply and are valid or the
@@ -468,19 +815,20 @@ void chain_controller::_apply_block(const signed_block& next_block)
     * when building a block.
     */
    for (const auto& cycle : next_block.cycles) {
-      for (const auto& thread : cycle) {
-         for(const auto& trx : thread.generated_input ) {
-#warning TODO: Process generated transaction
-         }
-         for(const auto& trx : thread.user_input ) {
-            apply_transaction(trx);
-         }
-      }
+      validate_cycle_scopes(cycle);
+      apply_cycle(cycle);
    }
 
    update_global_properties(next_block);
    update_global_dynamic_data(next_block);
    update_signing_producer(signing_producer, next_block);
+
+   // Entries left over from a block which failed to apply, or from the branch we switched away from, are replaced
+   truncate_branch_block_ids(next_block_num - 1);
+   if (!_branch_block_ids.empty() && _branch_block_ids.back() != next_block.previous)
+      _branch_block_ids.clear();
+   _branch_block_ids.push_back(next_block.id());
+
    update_last_irreversible_block();
 
    create_block_summary(next_block);
@@ -492,44 +840,251 @@ void chain_controller::_apply_block(const signed_block& next_block)
 
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
-void chain_controller::apply_transaction(const SignedTransaction& trx, uint32_t skip)
+void chain_controller::validate_cycle_scopes(const cycle& c)const {
+   if (c.size() < 2) return;
+
+   vector<flat_set<AccountName>> reads, writes;
+   reads.reserve(c.size());
+   writes.reserve(c.size());
+   flat_map<AccountName, size_t> writer;
+   for (size_t i = 0; i < c.size(); ++i) {
+      reads.emplace_back();
+      writes.emplace_back();
+      auto add_scopes = [&reads, &writes](const auto& trx) {
+         auto r = trx.read_scope();
+         auto w = trx.write_scope();
+         reads.back().insert(r.begin(), r.end());
+         writes.back().insert(w.begin(), w.end());
+      };
+      for (const auto& id : c[i].generated_input) {
+         // A transaction which is not queued fails when applied; there are no scopes to check
+         auto queued = _db.find<generated_transaction_object, by_trx_id>(id);
+         if (queued == nullptr) continue;
+         generated_transaction trx;
+         fc::datastream<const char*> ds(queued->packed_trx.data(), queued->packed_trx.size());
+         fc::raw::unpack(ds, static_cast<types::Transaction&>(trx));
+         add_scopes(trx);
+      }
+      for (const auto& trx : c[i].user_input)
+         add_scopes(trx);
+      for (const auto& scope : writes.back()) {
+         auto itr = writer.find(scope);
+         EOS_ASSERT(itr == writer.end(), block_concurrency_exception,
+                    "Threads ${a} and ${b} of a cycle both write scope ${s}", ("a", itr->second)("b", i)("s", scope));
+         writer[scope] = i;
+      }
+   }
+   for (size_t i = 0; i < c.size(); ++i) {
+      for (const auto& scope : reads[i]) {
+         auto itr = writer.find(scope);
+         EOS_ASSERT(itr == writer.end() || itr->second == i, block_concurrency_exception,
+                    "Thread ${a} of a cycle reads scope ${s} written by thread ${b}",
+                    ("a", i)("b", itr->second)("s", scope));
+      }
+   }
+}
+
+/**
+ * Threads within a cycle have disjoint scopes (see @ref validate_cycle_scopes), so the only ordering which matters is
+ * the barrier between cycles. The context-free part of validation for every transaction in the cycle is spread over
+ * the thread pool; each thread's state changes are then made in an undo session of its own, which is merged into the
+ * block's session once the thread completes.
+ *
+ * chainbase does not support concurrent writers, so the threads' state changes are applied one after another.
+ */
+void chain_controller::apply_cycle(const cycle& c) {
+   vector<const SignedTransaction*> trxs;
+   for (const auto& thread : c)
+      for (const auto& trx : thread.user_input)
+         trxs.push_back(&trx);
+
+   // Serializing and hashing each transaction is independent of the others, as is context-free validation
+   vector<optional<transaction_metadata>> metadata(trxs.size());
+   const bool validate = !(_skip_flags & skip_validate);
+   _thread_pool->for_each(trxs.size(), [this, &trxs, &metadata, validate](size_t i) {
+      metadata[i] = transaction_metadata(*trxs[i]);
+      if (validate)
+         validate_messages_context_free(*metadata[i]);
+   });
+
+   auto next = metadata.begin();
+   for (const auto& thread : c) {
+      auto session = _db.start_undo_session(true);
+      for (const auto& id : thread.generated_input)
+         apply_generated_transaction(id);
+      for (size_t i = 0; i < thread.user_input.size(); ++i, ++next) {
+         apply_transaction(**next, _skip_flags | skip_validate);
+      }
+      session.squash();
+   }
+}
+
+void chain_controller::apply_transaction(const transaction_metadata& trx, uint32_t skip)
 {
    with_skip_flags( skip, [&]() { _apply_transaction(trx); });
 }
 
-void chain_controller::validate_transaction(const SignedTransaction& trx)const {
+void chain_controller::validate_transaction(const transaction_metadata& meta)const {
 try {
+   utilities::scoped_timer timer(metrics().validate_transaction);
+   const SignedTransaction& trx = meta.trx();
    EOS_ASSERT(trx.messages.size() > 0, transaction_exception, "A transaction must have at least one message");
 
-   validate_uniqueness(trx);
+   validate_uniqueness(meta);
    validate_tapos(trx);
    validate_referenced_accounts(trx);
    validate_expiration(trx);
 
-   for (const auto& tm : trx.messages) { /// TODO: this loop can be processed in parallel
-      const Message* m = reinterpret_cast<const Message*>(&tm); //  m(tm);
+   // Recovery asserts that no signature is repeated
+   if (should_check_authorization())
+      check_authorization(trx, get_signature_keys(trx, meta.sig_digest(_chain_id)));
+   else if (!(_skip_flags & skip_transaction_signatures))
+      get_signature_keys(trx, meta.sig_digest(_chain_id));
+
+   for (size_t i = 0; i < trx.messages.size(); ++i) {
+      const Message* m = reinterpret_cast<const Message*>(&trx.messages[i]); //  m(tm);
+      validate_message(*m, meta.payload(i), _skip_flags & skip_validate);
+   }
+} FC_CAPTURE_AND_RETHROW( (meta.trx()) ) }
+
+void chain_controller::validate_message(const Message& m, std::shared_ptr<message_payload_cache> payload,
+                                        bool skip_native)const {
+   if (!payload)
+      payload = std::make_shared<message_payload_cache>();
+   m.for_each_handler( [&]( const AccountName& a ) {
+      message_validate_context mvc(_db,m,a,payload);
+      if (auto handler = find_validate_handler(a, m.type)) {
+         if (!skip_native)
+            (*handler)(mvc);
+         return;
+      }
+      const auto& acnt = _db.get<account_object,by_name>( a );
+      if( acnt.code.size() ) {
+         execution_timer wasm_timer;
+         auto charge_wasm_time = fc::make_scoped_exit([&]{ _wasm_time += wasm_timer.cpu(); });
+         wasm_interface::get().validate( mvc );
+      }
+   });
+}
+
+void chain_controller::validate_generated_transaction(const generated_transaction& trx,
+                                                      const AccountName& generator)const {
+try {
+   EOS_ASSERT(trx.messages.size() > 0, transaction_exception, "A transaction must have at least one message");
+   for (const auto& auth : trx.authorization)
+      EOS_ASSERT(auth.account == generator, tx_missing_other_auth,
+                 "Contract ${generator} generated a transaction declaring the authority of ${account}",
+                 ("generator", generator)("account", auth.account));
+
+   for (const auto& message : trx.messages) {
+      EOS_ASSERT(message.sender == generator, tx_missing_active_auth,
+                 "Contract ${generator} generated a message sent by ${sender}",
+                 ("generator", generator)("sender", message.sender));
+      validate_referenced_accounts(message);
+      // Nothing validated these messages before, so their native handlers run even where they are skipped for the
+      // user input of a block, which was validated when it was pushed
+      validate_message(*reinterpret_cast<const Message*>(&message), nullptr, false);
+   }
+} FC_CAPTURE_AND_RETHROW( (trx)(generator) ) }
+
+void chain_controller::validate_messages_context_free(const transaction_metadata& meta)const {
+try {
+   const SignedTransaction& trx = meta.trx();
+   for (size_t i = 0; i < trx.messages.size(); ++i) {
+      const Message* m = reinterpret_cast<const Message*>(&trx.messages[i]);
       m->for_each_handler( [&]( const AccountName& a ) {
-         message_validate_context mvc(_db,*m,a);
-         auto contract_handlers_itr = message_validate_handlers.find(a);
-         if (contract_handlers_itr != message_validate_handlers.end()) {
-            auto message_handler_itr = contract_handlers_itr->second.find({a, m->type});
-            if (message_handler_itr != contract_handlers_itr->second.end()) {
-               message_handler_itr->second(mvc);
-               return;
-            }
+         if (auto handler = find_validate_handler(a, m->type)) {
+            message_validate_context mvc(_db,*m,a,meta.payload(i));
+            (*handler)(mvc);
          }
-         const auto& acnt = _db.get<account_object,by_name>( a );
-         if( acnt.code.size() ) {
-            wasm_interface::get().validate( mvc );
-         }
-       });
+      });
+   }
+} FC_CAPTURE_AND_RETHROW( (meta.trx()) ) }
+
+void chain_controller::recover_signature_keys(const vector<const SignedTransaction*>& trxs)const {
+   _thread_pool->for_each(trxs.size(), [this, &trxs](size_t i) {
+      try {
+         get_signature_keys(*trxs[i], trxs[i]->sig_digest(_chain_id));
+      } catch (const fc::exception&) {
+         // Bad signatures are reported when the transaction is validated
+      }
+   });
+}
+
+flat_set<public_key_type> chain_controller::get_signature_keys(const SignedTransaction& trx,
+                                                               const digest_type& sig_digest)const
+{ try {
+   flat_set<public_key_type> result;
+   for (const auto& sig : trx.signatures) {
+      EOS_ASSERT(result.insert(_recovered_keys->recover(sig_digest, sig)).second, tx_duplicate_sig,
+                 "Duplicate Signature detected");
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
+void chain_controller::check_authorization(const SignedTransaction& trx, const flat_set<public_key_type>& keys)const {
+   // Every message is sent with the authority of its sender, which the transaction must declare
+   for (const auto& message : trx.messages) {
+      auto declared = std::find_if(trx.authorizations.begin(), trx.authorizations.end(),
+                                   [&message](const auto& a) { return a.account == message.sender; });
+      EOS_ASSERT(declared != trx.authorizations.end(), tx_missing_active_auth,
+                 "Transaction declares no authorization of ${account}, which sends a message",
+                 ("account", message.sender));
+   }
+
+   authority_checker checker(_permission_cache, _db, keys);
+   for (const auto& declared : trx.authorizations) {
+      bool satisfied = checker.satisfied(declared);
+      EOS_ASSERT(satisfied || declared.permission != "active", tx_missing_active_auth,
+                 "Missing active authority of ${account}", ("account", declared.account));
+      EOS_ASSERT(satisfied || declared.permission != "owner", tx_missing_owner_auth,
+                 "Missing owner authority of ${account}", ("account", declared.account));
+      EOS_ASSERT(satisfied, tx_missing_other_auth, "Missing ${permission} authority of ${account}",
+                 ("account", declared.account)("permission", declared.permission));
+   }
+}
+
+void chain_controller::precompile_contracts(const SignedTransaction& trx, bool authorized)const {
+   auto is_set_code = [](const types::Message& m) {
+      return m.recipient == config::SystemContractName && m.type == "SetCode";
+   };
+   if (std::none_of(trx.messages.begin(), trx.messages.end(), is_set_code))
+      return;
+
+   try {
+      // Code is only compiled ahead of time for authorized transactions, so that compiling it costs whoever signed
+      // the transaction, rather than anybody who can send the node one
+      if (!authorized)
+         check_authorization(trx, get_signature_keys(trx, trx.sig_digest(_chain_id)));
+      for (const auto& message : trx.messages)
+         if (is_set_code(message))
+            wasm_interface::precompile(fc::raw::unpack<types::SetCode>(message.data).code);
+   } catch (const fc::exception&) {
+      // An unauthorized transaction or malformed message is reported when the transaction is applied
    }
+}
+
+void chain_controller::precompile_contracts(const signed_block& block, bool authorized)const {
+   for (const auto& cycle : block.cycles)
+      for (const auto& thread : cycle)
+         for (const auto& trx : thread.user_input)
+            precompile_contracts(trx, authorized);
+}
 
-} FC_CAPTURE_AND_RETHROW( (trx) ) }
+const message_validate_handler* chain_controller::find_validate_handler(const AccountName& contract,
+                                                                          const TypeName& type)const {
+   auto native = _message_handlers.find(contract, contract, type);
+   if (native && native->validate)
+      return &native->validate;
+   return nullptr;
+}
 
-void chain_controller::validate_uniqueness( const SignedTransaction& trx )const {
+void chain_controller::validate_uniqueness( const transaction_metadata& trx )const {
    if( !should_check_for_duplicate_transactions() ) return;
 
+   // Most transactions are new, and the filter can tell so without searching the index
+   if (!_known_transactions.may_contain(trx.id())) return;
+
    auto transaction = _db.find<transaction_object, by_trx_id>(trx.id());
    EOS_ASSERT(transaction == nullptr, transaction_exception, "Transaction is not unique");
 }
@@ -549,27 +1104,30 @@ void chain_controller::validate_referenced_accounts(const SignedTransaction& trx
    for(const auto& auth : trx.authorizations) {
       require_account(auth.account);
    }
-   for(const auto& msg : trx.messages) {
-      require_account(msg.sender);
-      require_account(msg.recipient);
-      const AccountName* previous_notify_account = nullptr;
-      for(const auto& current_notify_account : msg.notify) {
-         require_account(current_notify_account);
-         if(previous_notify_account) {
-            EOS_ASSERT(current_notify_account < *previous_notify_account, message_validate_exception,
-                       "Message notify accounts out of order. Possibly a bug in the wallet?");
-         }
+   for(const auto& msg : trx.messages)
+      validate_referenced_accounts(msg);
+}
 
-         EOS_ASSERT(current_notify_account != msg.sender, message_validate_exception,
-                    "Message sender is listed in accounts to notify. Possibly a bug in the wallet?");
-         EOS_ASSERT(current_notify_account != msg.recipient, message_validate_exception,
-                    "Message recipient is listed in accounts to notify. Possibly a bug in the wallet?");
-         previous_notify_account = &current_notify_account;
+void chain_controller::validate_referenced_accounts(const types::Message& msg)const {
+   require_account(msg.sender);
+   require_account(msg.recipient);
+   const AccountName* previous_notify_account = nullptr;
+   for(const auto& current_notify_account : msg.notify) {
+      require_account(current_notify_account);
+      if(previous_notify_account) {
+         EOS_ASSERT(current_notify_account < *previous_notify_account, message_validate_exception,
+                    "Message notify accounts out of order. Possibly a bug in the wallet?");
       }
+
+      EOS_ASSERT(current_notify_account != msg.sender, message_validate_exception,
+                 "Message sender is listed in accounts to notify. Possibly a bug in the wallet?");
+      EOS_ASSERT(current_notify_account != msg.recipient, message_validate_exception,
+                 "Message recipient is listed in accounts to notify. Possibly a bug in the wallet?");
+      previous_notify_account = &current_notify_account;
    }
 }
 
-void chain_controller::validate_expiration(const SignedTransaction& trx) const
+void chain_controller::validate_expiration(const types::Transaction& trx) const
 { try {
    fc::time_point_sec now = head_block_time();
    const BlockchainConfiguration& chain_configuration = get_global_properties().configuration;
@@ -583,84 +1141,170 @@ void chain_controller::validate_expiration(const SignedTransaction& trx) const
 } FC_CAPTURE_AND_RETHROW((trx)) }
 
 
-void chain_controller::validate_message_precondition( precondition_validate_context& context )const 
+void chain_controller::validate_message_precondition( precondition_validate_context& context,
+                                                      const message_handlers* native )const
 { try {
-    const auto& m = context.msg;
-    auto contract_handlers_itr = precondition_validate_handlers.find( m.recipient );
-    if( contract_handlers_itr != precondition_validate_handlers.end() ) {
-       auto message_handler_itr = contract_handlers_itr->second.find( {context.scope, m.type} );
-       if( message_handler_itr != contract_handlers_itr->second.end() ) {
-          message_handler_itr->second(context);
-          return;
-       }
+    if( native && native->precondition ) {
+       native->precondition(context);
+       return;
     }
     const auto& recipient = _db.get<account_object,by_name>( context.scope );
     if( recipient.code.size() ) {
+       execution_timer wasm_timer;
+       auto charge_wasm_time = fc::make_scoped_exit([&]{ _wasm_time += wasm_timer.cpu(); });
        wasm_interface::get().precondition( context );
     }
 } FC_CAPTURE_AND_RETHROW() }
 
-void chain_controller::process_message(Message message) {
-   apply_context apply_ctx(_db, message, message.recipient);
+void chain_controller::process_message(const Message& message, std::shared_ptr<message_payload_cache> payload) {
+   utilities::scoped_timer timer(metrics().process_message);
+   metrics().messages_processed.add();
+   if (!payload)
+      payload = std::make_shared<message_payload_cache>();
+   apply_context apply_ctx(_db, message, message.recipient, payload);
+   auto native = _message_handlers.find(message.recipient, message.recipient, message.type);
 
    /** TODO: pre condition validation and application can occur in parallel */
    /** TODO: verify that message is fully authorized
           (check that @ref SignedTransaction::authorizations are all present) */
-   validate_message_precondition(apply_ctx);
-   apply_message(apply_ctx);
+   // Transactions are validated as their contract generates them, so that one which is invalid fails the message
+   auto collect_generated = [this](apply_context& context) {
+      for (auto& trx : context.generated) {
+         validate_generated_transaction(trx, context.scope);
+         _generated_transactions.push_back(std::move(trx));
+      }
+   };
+
+   validate_message_precondition(apply_ctx, native);
+   apply_message(apply_ctx, native);
+   collect_generated(apply_ctx);
+   // Permissions are written only by the system contract's native handlers
+   if (message.recipient == config::SystemContractName)
+      _permission_cache.clear();
 
    for (const auto& notify_account : message.notify) {
       try {
-         apply_context notify_ctx(_db, message, notify_account);
-         validate_message_precondition(notify_ctx);
-         apply_message(notify_ctx);
+         apply_context notify_ctx(_db, message, notify_account, payload);
+         native = _message_handlers.find(message.recipient, notify_account, message.type);
+         validate_message_precondition(notify_ctx, native);
+         apply_message(notify_ctx, native);
+         collect_generated(notify_ctx);
       } FC_CAPTURE_AND_RETHROW((notify_account)(message))
    }
 }
 
-void chain_controller::apply_message( apply_context& context ) 
+void chain_controller::apply_message( apply_context& context, const message_handlers* native )
 { try {
-    const auto& m = context.msg;
-    auto contract_handlers_itr = apply_handlers.find( m.recipient );
-    if( contract_handlers_itr != apply_handlers.end() ) {
-       auto message_handler_itr = contract_handlers_itr->second.find( {context.scope, m.type} );
-       if( message_handler_itr != contract_handlers_itr->second.end() ) {
-          message_handler_itr->second(context);
-          return;
-       }
+    if( native && native->apply ) {
+       native->apply(context);
+       return;
     }
     const auto& recipient = _db.get<account_object,by_name>( context.scope );
     if( recipient.code.size() ) {
+       execution_timer wasm_timer;
+       auto charge_wasm_time = fc::make_scoped_exit([&]{ _wasm_time += wasm_timer.cpu(); });
        wasm_interface::get().apply( context );
     }
 
 } FC_CAPTURE_AND_RETHROW((context.msg)) }
 
 
-void chain_controller::_apply_transaction(const SignedTransaction& trx)
+const transaction_execution_time& chain_controller::_apply_transaction(const transaction_metadata& trx)
 { try {
+   utilities::scoped_timer metrics_timer(metrics().apply_transaction);
+   metrics().transactions_applied.add();
+   execution_timer timer;
+   auto wasm_start = _wasm_time;
+   transaction_execution_time time;
+   time.id = trx.id();
+
    validate_transaction(trx);
 
-   for (const auto& message : trx.messages) {
-      process_message(message);
+   // Anything left over from a transaction which failed to apply was undone with it
+   _generated_transactions.clear();
+   const auto& messages = trx.trx().messages;
+   time.messages.reserve(messages.size());
+   for (size_t i = 0; i < messages.size(); ++i) {
+      execution_timer message_timer;
+      auto message_wasm_start = _wasm_time;
+      process_message(messages[i], trx.payload(i));
+      time.messages.push_back({messages[i].recipient, messages[i].type, message_timer.wall(), message_timer.cpu(),
+                               _wasm_time - message_wasm_start});
    }
 
+   queue_generated_transactions(trx.id());
+
    //Insert transaction into unique transactions database.
    if (should_check_for_duplicate_transactions())
    {
       _db.create<transaction_object>([&](transaction_object& transaction) {
-         transaction.trx_id = trx.id(); /// TODO: consider caching ID
-         transaction.trx = trx;
+         transaction.trx_id = trx.id();
+         transaction.expiration = trx.trx().expiration;
+         if (_store_transaction_bodies)
+            transaction.packed_trx.assign(trx.packed().data(), trx.packed().size());
       });
+      _known_transactions.insert(trx.id(), trx.trx().expiration);
    }
-} FC_CAPTURE_AND_RETHROW((trx)) }
+
+   time.wall = timer.wall();
+   time.cpu = charged_cpu_time(timer.cpu());
+   time.wasm = _wasm_time - wasm_start;
+   _recent_execution_times.push_back(std::move(time));
+   if (_recent_execution_times.size() > config::ExecutionTimeHistorySize)
+      _recent_execution_times.pop_front();
+   return _recent_execution_times.back();
+} FC_CAPTURE_AND_RETHROW((trx.trx())) }
+
+void chain_controller::queue_generated_transactions(const transaction_id_type& source) {
+   for (uint32_t i = 0; i < _generated_transactions.size(); ++i) {
+      auto& trx = _generated_transactions[i];
+      validate_expiration(trx);
+
+      // IDs depend only on the generating transaction, so every node applying it assigns the same ones
+      digest_type::encoder enc;
+      fc::raw::pack(enc, source);
+      fc::raw::pack(enc, i);
+      trx.id = enc.result();
+
+      const types::Transaction& body = trx;
+      auto size = fc::raw::pack_size(body);
+      _db.create<generated_transaction_object>([&](generated_transaction_object& queued) {
+         queued.trx_id = trx.id;
+         queued.expiration = trx.expiration;
+         queued.packed_trx.resize(size);
+         fc::datastream<char*> ds(&queued.packed_trx[0], size);
+         fc::raw::pack(ds, body);
+      });
+   }
+   _generated_transactions.clear();
+}
+
+void chain_controller::apply_generated_transaction(const generated_transaction_id_type& id)
+{ try {
+   auto queued = _db.find<generated_transaction_object, by_trx_id>(id);
+   EOS_ASSERT(queued != nullptr, transaction_exception, "Generated transaction is not queued");
+   EOS_ASSERT(head_block_time() <= queued->expiration, transaction_exception, "Generated transaction is expired",
+              ("now", head_block_time())("trx.exp", queued->expiration));
+
+   generated_transaction trx;
+   fc::datastream<const char*> ds(queued->packed_trx.data(), queued->packed_trx.size());
+   fc::raw::unpack(ds, static_cast<types::Transaction&>(trx));
+   trx.id = id;
+   _db.remove(*queued);
+
+   _generated_transactions.clear();
+   for (const auto& message : trx.messages)
+      process_message(*reinterpret_cast<const Message*>(&message));
+   queue_generated_transactions(id);
+} FC_CAPTURE_AND_RETHROW((id)) }
 
 void chain_controller::require_account(const types::AccountName& name) const {
    auto account = _db.find<account_object, by_name>(name);
    FC_ASSERT(account != nullptr, "Account not found: ${name}", ("name", name));
 }
 
-const producer_object& chain_controller::validate_block_header(uint32_t skip, const signed_block& next_block)const {
+const producer_object& chain_controller::validate_block_header(uint32_t skip, const signed_block& next_block,
+                                                               const optional<public_key_type>& signee)const {
    EOS_ASSERT(head_block_id() == next_block.previous, block_validate_exception, "",
               ("head_block_id",head_block_id())("next.prev",next_block.previous));
    EOS_ASSERT(head_block_time() < next_block.timestamp, block_validate_exception, "",
@@ -677,10 +1321,12 @@ const producer_object& chain_controller::validate_block_header(uint32_t skip, co
    }
    const producer_object& producer = get_producer(get_scheduled_producer(get_slot_at_time(next_block.timestamp)));
 
-   if(!(skip&skip_producer_signature))
-      EOS_ASSERT(next_block.validate_signee(producer.signing_key), block_validate_exception,
+   if(!(skip&skip_producer_signature)) {
+      public_key_type actual = signee? *signee : public_key_type(next_block.signee());
+      EOS_ASSERT(actual == producer.signing_key, block_validate_exception,
                  "Incorrect block producer key: expected ${e} but got ${a}",
-                 ("e", producer.signing_key)("a", public_key_type(next_block.signee())));
+                 ("e", producer.signing_key)("a", actual));
+   }
 
    if(!(skip&skip_producer_schedule_check)) {
       EOS_ASSERT(next_block.producer == producer.owner, block_validate_exception,
@@ -755,6 +1401,23 @@ uint32_t chain_controller::last_irreversible_block_num() const {
    return get_dynamic_global_properties().last_irreversible_block_num;
 }
 
+void chain_controller::truncate_branch_block_ids(uint32_t block_num) {
+   while (!_branch_block_ids.empty() && block_header::num_from_id(_branch_block_ids.back()) > block_num)
+      _branch_block_ids.pop_back();
+}
+
+void chain_controller::publish_head_block_state() {
+   const auto& dgp = get_dynamic_global_properties();
+   auto state = std::make_shared<head_block_state>();
+   state->head_block_num = dgp.head_block_number;
+   state->head_block_id = dgp.head_block_id;
+   state->head_block_time = dgp.time;
+   state->head_block_producer = dgp.current_producer;
+   state->recent_slots_filled = dgp.recent_slots_filled;
+   state->last_irreversible_block_num = dgp.last_irreversible_block_num;
+   std::atomic_store(&_head_block_state, std::shared_ptr<const head_block_state>(std::move(state)));
+}
+
 void chain_controller::initialize_indexes() {
    _db.add_index<account_index>();
    _db.add_index<permission_index>();
@@ -765,6 +1428,7 @@ void chain_controller::initialize_indexes() {
    _db.add_index<dynamic_global_property_multi_index>();
    _db.add_index<block_summary_multi_index>();
    _db.add_index<transaction_multi_index>();
+   _db.add_index<generated_transaction_multi_index>();
    _db.add_index<producer_multi_index>();
 }
 
@@ -798,25 +1462,55 @@ void chain_controller::initialize_chain(chain_initializer_interface& starter)
 } FC_CAPTURE_AND_RETHROW() }
 
 chain_controller::chain_controller(database& database, fork_database& fork_db, block_log& blocklog,
-                                   chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin)
-   : _db(database), _fork_db(fork_db), _block_log(blocklog), _admin(std::move(admin)) {
-
+                                   chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin,
+                                   const flat_map<uint32_t,block_id_type>& checkpoints)
+   : _db(database), _fork_db(fork_db), _block_log(blocklog), _block_log_writer(new block_log_writer(blocklog)),
+     _admin(std::move(admin)),
+     _chain_id(starter.get_chain_id()),
+     _recovered_keys(new recovered_key_cache(config::RecoveredKeyCacheSize)),
+     _known_transactions(config::TransactionFilterWindowSeconds, config::TransactionFilterWindowSize,
+                         config::TransactionFilterFalsePositiveRate),
+     _thread_pool(new thread_pool()) {
+
+   add_checkpoints(checkpoints);
    initialize_indexes();
    starter.register_types(*this, _db);
+   _message_handlers.freeze();
    initialize_chain(starter);
    spinup_db();
    spinup_fork_db();
+   initialize_transaction_filter();
 
    if (_block_log.read_head() && head_block_num() < _block_log.read_head()->block_num())
       replay();
+   publish_head_block_state();
 }
 
 chain_controller::~chain_controller() {
    clear_pending();
+   if (_block_log_writer) {
+      // With every irreversible block in the block log, the database can be committed up to the last of them
+      try {
+         _block_log_writer->wait();
+         _db.commit(std::min(last_irreversible_block_num(), _block_log_writer->last_durable_block_num()));
+      } catch (const fc::exception& e) {
+         elog("Unable to write the block log: ${e}", ("e", e.to_detail_string()));
+      }
+      _block_log_writer.reset();
+   }
    _db.flush();
    _fork_db.reset();
 }
 
+/**
+ * Replay runs as a three stage pipeline. A reader thread streams the blocks out of the block log in order and hands
+ * each to the thread pool, which computes the block's ID and merkle root; the blocks then wait in a bounded queue for
+ * this thread, which applies them. Reading, hashing and applying thus overlap, while the queue keeps the reader from
+ * getting arbitrarily far ahead.
+ *
+ * Blocks up to the last checkpoint are applied with all checks skipped (see @ref apply_block), so the pool only
+ * computes their IDs.
+ */
 void chain_controller::replay() {
    ilog("Replaying blockchain");
    auto start = fc::time_point::now();
@@ -827,19 +1521,64 @@ void chain_controller::replay() {
    }
 
    const auto last_block_num = last_block->block_num();
+   // The database may hold a prefix of the log already, if it was committed past the last replay
+   const uint32_t first_block_num = head_block_num() + 1;
+   const uint32_t replay_skip = skip_producer_signature |
+                                skip_transaction_signatures |
+                                skip_transaction_dupe_check |
+                                skip_tapos_check |
+                                skip_producer_schedule_check |
+                                skip_authority_check;
+   const uint32_t last_checkpoint = (_checkpoints.size() && _checkpoints.rbegin()->second != block_id_type())?
+                                       _checkpoints.rbegin()->first : 0;
+   if (last_checkpoint)
+      ilog("Skipping verification of blocks up to checkpoint #${n}", ("n", last_checkpoint));
+
+   using replay_item = std::pair<std::shared_ptr<signed_block>, std::shared_future<block_prevalidation>>;
+   bounded_queue<replay_item> queue(config::ReplayQueueSize);
+   std::exception_ptr read_error;
+   std::thread reader([this, &queue, &read_error, first_block_num, replay_skip, last_checkpoint] {
+      try {
+         auto blocks = _block_log.read_blocks_from(first_block_num);
+         while (auto next = blocks.next()) {
+            auto block = std::make_shared<signed_block>(std::move(*next));
+            uint32_t skip = block->block_num() <= last_checkpoint? ~0 : replay_skip;
+            auto checked = _thread_pool->post([this, block, skip] { return prevalidate(*block, skip); }).share();
+            if (!queue.push(replay_item(std::move(block), checked))) {
+               checked.wait();
+               break;
+            }
+         }
+      } catch (...) {
+         read_error = std::current_exception();
+      }
+      queue.close();
+   });
+   // The prevalidation tasks refer to this controller, so none may be left running if the replay fails
+   auto stop_reader = fc::make_scoped_exit([&queue, &reader] {
+      queue.close();
+      reader.join();
+      while (auto item = queue.pop())
+         item->second.wait();
+   });
 
    ilog("Replaying blocks...");
-   for (uint32_t i = 1; i <= last_block_num; ++i) {
+   for (uint32_t i = first_block_num; i <= last_block_num; ++i) {
       if (i % 5000 == 0)
          std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num<<"   \n";
-      fc::optional<signed_block> block = _block_log.read_block_by_num(i);
-      FC_ASSERT(block, "Could not find block #${n} in block_log!", ("n", i));
-      apply_block(*block, skip_producer_signature |
-                          skip_transaction_signatures |
-                          skip_transaction_dupe_check |
-                          skip_tapos_check |
-                          skip_producer_schedule_check |
-                          skip_authority_check);
+      auto item = queue.pop();
+      if (!item && read_error)
+         std::rethrow_exception(read_error);
+      FC_ASSERT(item, "Could not find block #${n} in block_log!", ("n", i));
+      item->second.wait();
+      const signed_block& block = *item->first;
+      FC_ASSERT(block.block_num() == i, "Wrong block was read from block log.",
+                ("returned", block.block_num())("expected", i));
+
+      const auto& checked = item->second.get();
+      _prevalidation = &checked;
+      auto on_exit = fc::make_scoped_exit( [this](){ _prevalidation = nullptr; } );
+      apply_block(block, replay_skip);
    }
    auto end = fc::time_point::now();
    ilog("Done replaying ${n} blocks, elapsed time: ${t} sec",
@@ -864,7 +1603,11 @@ void chain_controller::spinup_fork_db()
    if(last_block.valid()) {
       _fork_db.start_block(*last_block);
       if (last_block->id() != head_block_id()) {
-           FC_ASSERT(head_block_num() == 0, "last block ID does not match current chain state",
+           // The database may be behind the log, if the node stopped before committing blocks which reached the log.
+           // It must be on the same chain, though; the blocks it is missing are replayed.
+           auto behind = head_block_num() < last_block->block_num() &&
+                         (head_block_num() == 0 || get_block_id_for_num(head_block_num()) == head_block_id());
+           FC_ASSERT(behind, "last block ID does not match current chain state",
                      ("last_block->id", last_block->id())("head_block_num",head_block_num()));
       }
    }
@@ -925,7 +1668,9 @@ void chain_controller::update_global_dynamic_data(const signed_block& b) {
          dgp.recent_slots_filled = 0;
    });
 
-   _fork_db.set_max_size( _dgp.head_block_number - _dgp.last_irreversible_block_num + 1 );
+   // Irreversible blocks stay in the fork database until they are in the block log; see update_last_irreversible_block
+   auto last_durable_block_num = std::min(_dgp.last_irreversible_block_num, _block_log_writer->last_durable_block_num());
+   _fork_db.set_max_size( _dgp.head_block_number - last_durable_block_num + 1 );
 }
 
 void chain_controller::update_signing_producer(const producer_object& signing_producer, const signed_block& new_block)
@@ -942,6 +1687,7 @@ void chain_controller::update_signing_producer(const producer_object& signing_pr
 
 void chain_controller::update_last_irreversible_block()
 {
+   utilities::scoped_timer timer(metrics().update_last_irreversible_block);
    const global_property_object& gpo = get_global_properties();
    const dynamic_global_property_object& dpo = get_dynamic_global_properties();
 
@@ -966,37 +1712,58 @@ void chain_controller::update_last_irreversible_block()
       });
    }
 
-   // Write newly irreversible blocks to disk. First, get the number of the last block on disk...
-   auto old_last_irreversible_block = _block_log.head();
-   int last_block_on_disk = 0;
-   // If this is null, there are no blocks on disk, so the zero is correct
-   if (old_last_irreversible_block)
-      last_block_on_disk = old_last_irreversible_block->block_num();
-
-   if (last_block_on_disk < new_last_irreversible_block_num)
-      for (auto block_to_write = last_block_on_disk + 1;
-           block_to_write <= new_last_irreversible_block_num;
-           ++block_to_write) {
-         auto block = fetch_block_by_number(block_to_write);
-         assert(block);
-         _block_log.append(*block);
-      }
+   // Queue newly irreversible blocks to be written to disk
+   for (auto block_to_write = _block_log_writer->last_queued_block_num() + 1;
+        block_to_write <= new_last_irreversible_block_num;
+        ++block_to_write) {
+      auto block = fetch_block_by_number(block_to_write);
+      FC_ASSERT(block, "missing irreversible block ${n}", ("n", block_to_write));
+      _block_log_writer->append(std::move(*block));
+   }
+
+   // Blocks on their way to disk are kept in the fork database, so they can still be found, and in the undo history,
+   // so that after a crash the database is rewound to a block which made it into the block log
+   auto last_durable_block_num = std::min(new_last_irreversible_block_num,
+                                          _block_log_writer->last_durable_block_num());
+   while (!_branch_block_ids.empty() &&
+          block_header::num_from_id(_branch_block_ids.front()) <= last_durable_block_num)
+      _branch_block_ids.pop_front();
 
    // Trim fork_database and undo histories
-   _fork_db.set_max_size(head_block_num() - new_last_irreversible_block_num + 1);
-   _db.commit(new_last_irreversible_block_num);
+   _fork_db.set_max_size(head_block_num() - last_durable_block_num + 1);
+   _db.commit(last_durable_block_num);
 }
 
 void chain_controller::clear_expired_transactions()
 { try {
    //Look for expired transactions in the deduplication list, and remove them.
    //Transactions must have expired by at least two forking windows in order to be removed.
+   //The index is ordered by expiration, so the expired transactions are the ones at its front.
    auto& transaction_idx = _db.get_mutable_index<transaction_multi_index>();
    const auto& dedupe_index = transaction_idx.indices().get<by_expiration>();
-   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.rbegin()->trx.expiration) )
-      transaction_idx.remove(*dedupe_index.rbegin());
+   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.begin()->expiration) )
+      transaction_idx.remove(*dedupe_index.begin());
+
+   // Generated transactions which were not included in a block by their expiration are dropped
+   auto& generated_idx = _db.get_mutable_index<generated_transaction_multi_index>();
+   const auto& generated_queue = generated_idx.indices().get<by_expiration>();
+   while( (!generated_queue.empty()) && (head_block_time() > generated_queue.begin()->expiration) )
+      generated_idx.remove(*generated_queue.begin());
+
+   // Rotate the ID filter. Removing an expired transaction from the index is undone if its block is popped, so a
+   // window may only be dropped once it ended before the last irreversible block, which can never be popped.
+   if (_known_transactions.earliest_window_end() < head_block_time()) {
+      if (auto irreversible = fetch_block_by_number(last_irreversible_block_num()))
+         _known_transactions.expire(irreversible->timestamp);
+   }
 } FC_CAPTURE_AND_RETHROW() }
 
+void chain_controller::initialize_transaction_filter() {
+   _known_transactions.clear();
+   for (const auto& trx : _db.get_index<transaction_multi_index, by_id>())
+      _known_transactions.insert(trx.trx_id, trx.expiration);
+}
+
 using boost::container::flat_set;
 
 types::AccountName chain_controller::get_scheduled_producer(uint32_t slot_num)const
@@ -1043,13 +1810,13 @@ uint32_t chain_controller::producer_participation_rate()const
 }
 
 void chain_controller::set_validate_handler( const AccountName& contract, const AccountName& scope, const TypeName& action, message_validate_handler v ) {
-   message_validate_handlers[contract][std::make_pair(scope,action)] = v;
+   _message_handlers.at(contract, scope, action).validate = v;
 }
 void chain_controller::set_precondition_validate_handler(  const AccountName& contract, const AccountName& scope, const TypeName& action, precondition_validate_handler v ) {
-   precondition_validate_handlers[contract][std::make_pair(scope,action)] = v;
+   _message_handlers.at(contract, scope, action).precondition = v;
 }
 void chain_controller::set_apply_handler( const AccountName& contract, const AccountName& scope, const TypeName& action, apply_handler v ) {
-   apply_handlers[contract][std::make_pair(scope,action)] = v;
+   _message_handlers.at(contract, scope, action).apply = v;
 }
 
 chain_initializer_interface::~chain_initializer_interface() {}
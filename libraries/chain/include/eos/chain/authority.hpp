@@ -10,7 +10,7 @@ namespace eos {
    /**
     *  Makes sure all keys are unique and sorted and all account permissions are unique and sorted
     */
-   inline bool validate( types::Authority& auth ) {
+   inline bool validate( const types::Authority& auth ) {
       const types::KeyPermissionWeight* prev = nullptr;
       for( const auto& k : auth.keys ) {
          if( !prev ) prev = &k;
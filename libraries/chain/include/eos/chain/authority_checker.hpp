@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/account_object.hpp>
+#include <eos/chain/authority.hpp>
+
+#include <chainbase/chainbase.hpp>
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace eos { namespace chain {
+
+   /// A permission as the authority checker needs it, copied out of its @ref permission_object
+   struct resolved_permission {
+      AccountName              owner;
+      PermissionName           name;
+      /// The permission of the same account this one derives from, which may do anything this one may
+      optional<PermissionName> parent;
+      types::Authority         auth;
+   };
+
+   /// std::less does not find eos::operator< for types::AccountPermission, so name it explicitly
+   struct permission_level_less {
+      bool operator()(const types::AccountPermission& a, const types::AccountPermission& b)const {
+         return eos::operator<(a, b);
+      }
+   };
+
+   /**
+    * @brief Memo of resolved permissions, shared by the authority checks of many transactions
+    *
+    * The cache does not notice changes to the database by itself. Its owner must clear it whenever permissions may
+    * have changed: when a message which may write them is applied, and when changes are undone.
+    */
+   class permission_cache {
+      public:
+         /// @return the permission named by level, resolving it if it is not cached, or nullptr if there is none
+         const resolved_permission* get(const chainbase::database& db, const types::AccountPermission& level);
+
+         void clear() { _permissions.clear(); }
+
+         size_t   size()const   { return _permissions.size(); }
+         uint64_t hits()const   { return _hits; }
+         uint64_t misses()const { return _misses; }
+
+      private:
+         /// Permissions which do not exist are cached as nullptr
+         std::map<types::AccountPermission, std::unique_ptr<resolved_permission>, permission_level_less> _permissions;
+         uint64_t _hits = 0;
+         uint64_t _misses = 0;
+   };
+
+   /**
+    * @brief Decides whether a set of keys satisfies permissions
+    *
+    * An authority is satisfied when the weights of its keys which are provided, plus the weights of its account
+    * permissions which are satisfied in turn, reach its threshold. A permission is satisfied when its authority is, or
+    * when its parent permission is. Account permissions nest at most config::MaxAuthorityDepth deep, and a permission
+    * reached again through its own authority does not count towards it.
+    *
+    * Results are memoized per permission and depth for the life of the checker, which is meant to check one
+    * transaction. A permission is not memoized when its result counted an enclosing permission, reached again while
+    * still being decided, as unsatisfied: that only holds while checking the enclosing permission.
+    */
+   class authority_checker {
+      public:
+         authority_checker(permission_cache& permissions, const chainbase::database& db,
+                           const flat_set<public_key_type>& keys)
+            : _permissions(permissions), _db(db), _keys(keys) {}
+
+         bool satisfied(const types::AccountPermission& level, uint32_t depth = 0);
+         bool satisfied(const types::Authority& auth, uint32_t depth = 0);
+
+      private:
+         /// lowest_reached is lowered to the stack position of any undecided permission the result depended on
+         bool check(const types::AccountPermission& level, uint32_t depth, uint32_t& lowest_reached);
+         bool check(const types::Authority& auth, uint32_t depth, uint32_t& lowest_reached);
+
+         struct result_key_less {
+            bool operator()(const std::pair<types::AccountPermission, uint32_t>& a,
+                            const std::pair<types::AccountPermission, uint32_t>& b)const {
+               return std::tie(a.first.account, a.first.permission, a.second) <
+                      std::tie(b.first.account, b.first.permission, b.second);
+            }
+         };
+
+         permission_cache&                 _permissions;
+         const chainbase::database&        _db;
+         const flat_set<public_key_type>&  _keys;
+         /// Permissions being decided, with their position on the stack of nested checks
+         std::map<types::AccountPermission, uint32_t, permission_level_less> _in_progress;
+         std::map<std::pair<types::AccountPermission, uint32_t>, bool, result_key_less> _results;
+   };
+
+} } // eos::chain
+
+FC_REFLECT(eos::chain::resolved_permission, (owner)(name)(parent)(auth))
@@ -78,6 +78,21 @@ namespace eos { namespace chain {
       vector<cycle> cycles;
    };
 
+   /**
+    * @brief The results of the checks of a block which depend on nothing but the block itself
+    *
+    * These are the costly parts of validating a block, so they may be computed on any thread ahead of applying the
+    * block. A result which was not computed is left unset, and is computed when the block is applied instead.
+    */
+   struct block_prevalidation {
+      block_id_type             id;
+      optional<checksum_type>   merkle_root;
+      /// The key which signed the block, if it could be recovered
+      optional<public_key_type> signee;
+      /// Whether compiling the contract code set by the block was started already
+      bool                      contracts_precompiled = false;
+   };
+
 } } // eos::chain
 
 FC_REFLECT(eos::chain::block_header, (previous)(timestamp)(transaction_merkle_root)(producer)(producer_changes))
@@ -2,6 +2,8 @@
 #include <fc/filesystem.hpp>
 #include <eos/chain/block.hpp>
 
+#include <fstream>
+
 namespace eos { namespace chain {
 
    namespace detail { class block_log_impl; }
@@ -29,6 +31,8 @@ namespace eos { namespace chain {
     *
     * The main file is the only file that needs to persist. The index file can be reconstructed during a
     * linear scan of the main file.
+    *
+    * All methods may be called from any thread; appending and reading are serialized internally.
     */
 
    class block_log {
@@ -38,7 +42,10 @@ namespace eos { namespace chain {
          ~block_log();
 
          uint64_t append(const signed_block& b);
+         /// Hand what was appended to the operating system
          void flush();
+         /// Flush, and wait for the operating system to write the files to disk
+         void sync();
          std::pair<signed_block, uint64_t> read_block(uint64_t file_pos)const;
          optional<signed_block> read_block_by_num(uint32_t block_num)const;
          optional<signed_block> read_block_by_id(const block_id_type& id)const {
@@ -50,10 +57,33 @@ namespace eos { namespace chain {
           */
          uint64_t get_block_pos(uint32_t block_num) const;
          optional<signed_block> read_head()const;
-         const optional<signed_block>& head()const;
+         optional<signed_block> head()const;
 
          static const uint64_t npos = std::numeric_limits<uint64_t>::max();
 
+         /**
+          * @brief Reads the blocks of a log in order
+          *
+          * The reader walks the main file sequentially, never seeking or consulting the index. It has a stream of its
+          * own, so it may be used from another thread provided nothing is appended to the log meanwhile.
+          */
+         class reader {
+            public:
+               /// @return the next block, or an empty optional after the head block
+               optional<signed_block> next();
+
+            private:
+               friend class block_log;
+               reader(const fc::path& block_file, uint64_t pos);
+
+               std::ifstream _stream;
+               uint64_t      _pos;
+               uint64_t      _end_pos;
+         };
+
+         /// @return a reader which starts at block_num, or one which is already at the end if there is no such block
+         reader read_blocks_from(uint32_t block_num)const;
+
       private:
          void open(const fc::path& data_dir);
          void construct_index();
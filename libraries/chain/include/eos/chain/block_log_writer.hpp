@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/block_log.hpp>
+#include <eos/chain/bounded_queue.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief Appends blocks to a @ref block_log on a thread of its own
+    *
+    * Blocks queued with @ref append are written in order, in batches of whatever queued up while the previous batch was
+    * being written. After each batch the log is flushed to the operating system, and once sync_interval blocks have
+    * been written since the last sync, it is synced to disk. A sync_interval of zero leaves syncing to the operating
+    * system.
+    *
+    * @ref last_durable_block_num is the durability boundary: the last block known to be synced, or, without syncing,
+    * flushed. Callers must not discard what they would need to recover blocks above it.
+    *
+    * If writing fails, the writer stops; the error is rethrown by the next call to @ref append or @ref wait.
+    *
+    * Writing may be held back with @ref pause, leaving appended blocks queued until @ref resume.
+    */
+   class block_log_writer {
+      public:
+         block_log_writer(block_log& log, uint32_t sync_interval = 0);
+         /// Write every queued block and sync the log if a sync interval is set, then stop
+         ~block_log_writer();
+
+         /// Queue b, which must follow the last block queued; waits if too many blocks are queued already
+         void append(signed_block b);
+         /// Wait for every queued block to be written, and sync the log if a sync interval is set; not while paused
+         void wait();
+
+         /// Stop writing blocks after the batch being written, until @ref resume is called
+         void pause();
+         void resume();
+
+         void set_sync_interval(uint32_t blocks) { _sync_interval = blocks; }
+
+         uint32_t last_queued_block_num()const { return _last_queued; }
+         uint32_t last_durable_block_num()const { return _last_durable; }
+
+      private:
+         void run();
+         void rethrow_error();
+
+         block_log&                  _log;
+         bounded_queue<signed_block> _queue;
+         std::atomic<uint32_t>       _sync_interval;
+         /// Only accessed by the thread calling append
+         uint32_t                    _last_queued = 0;
+         std::atomic<uint32_t>       _last_written;
+         std::atomic<uint32_t>       _last_durable;
+
+         std::mutex                  _mutex;
+         std::condition_variable     _written;
+         bool                        _paused = false;
+         std::condition_variable     _resumed;
+         std::exception_ptr          _error;
+
+         std::thread                 _thread;
+   };
+
+} } // eos::chain
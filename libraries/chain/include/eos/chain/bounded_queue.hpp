@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/optional.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief A blocking FIFO with a fixed capacity, connecting a producer thread to a consumer thread
+    *
+    * push() waits while the queue is full, and pop() waits while it is empty, so the faster side of a pipeline is held
+    * back to the pace of the slower one with a bounded amount of work in between. Either side may close() the queue:
+    * pushes then fail, and pops drain what is left before reporting the end.
+    */
+   template<typename T>
+   class bounded_queue {
+      public:
+         explicit bounded_queue(size_t capacity) : _capacity(capacity) {}
+
+         /// Wait for room and enqueue value. @return false, without enqueuing, if the queue was closed
+         bool push(T value) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _not_full.wait(lock, [this] { return _closed || _items.size() < _capacity; });
+            if (_closed)
+               return false;
+            _items.emplace_back(std::move(value));
+            _not_empty.notify_one();
+            return true;
+         }
+
+         /// Wait for a value and dequeue it. @return an empty optional once the queue is closed and drained
+         fc::optional<T> pop() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _not_empty.wait(lock, [this] { return _closed || !_items.empty(); });
+            if (_items.empty())
+               return {};
+            fc::optional<T> value(std::move(_items.front()));
+            _items.pop_front();
+            _not_full.notify_one();
+            return value;
+         }
+
+         void close() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+            _not_full.notify_all();
+            _not_empty.notify_all();
+         }
+
+         size_t size()const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _items.size();
+         }
+
+      private:
+         const size_t            _capacity;
+         mutable std::mutex      _mutex;
+         std::condition_variable _not_full;
+         std::condition_variable _not_empty;
+         std::deque<T>           _items;
+         bool                    _closed = false;
+   };
+
+} } // eos::chain
@@ -26,6 +26,14 @@
 #include <eos/chain/account_object.hpp>
 #include <eos/chain/fork_database.hpp>
 #include <eos/chain/block_log.hpp>
+#include <eos/chain/block_log_writer.hpp>
+#include <eos/chain/thread_pool.hpp>
+#include <eos/chain/transaction_scheduler.hpp>
+#include <eos/chain/recovered_key_cache.hpp>
+#include <eos/chain/authority_checker.hpp>
+#include <eos/chain/transaction_id_filter.hpp>
+#include <eos/chain/message_handler_table.hpp>
+#include <eos/chain/execution_time.hpp>
 
 #include <chainbase/chainbase.hpp>
 #include <fc/scoped_exit.hpp>
@@ -39,20 +47,35 @@
 
 #include <fc/log/logger.hpp>
 
+#include <functional>
 #include <map>
+#include <memory>
 
 namespace eos { namespace chain {
    using database = chainbase::database;
    using boost::signals2::signal;
 
+   /// The state of the head block, as published by @ref chain_controller for readers on other threads
+   struct head_block_state {
+      uint32_t       head_block_num = 0;
+      block_id_type  head_block_id;
+      time_point_sec head_block_time;
+      AccountName    head_block_producer;
+      /// @see dynamic_global_property_object::recent_slots_filled
+      uint64_t       recent_slots_filled = 0;
+      uint32_t       last_irreversible_block_num = 0;
+   };
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
     */
    class chain_controller {
       public:
+         /// @param checkpoints checkpoints to enforce, given here so that they apply to the replay of the block log
          chain_controller(database& database, fork_database& fork_db, block_log& blocklog,
-                          chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin);
+                          chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin,
+                          const flat_map<uint32_t,block_id_type>& checkpoints = flat_map<uint32_t,block_id_type>());
          chain_controller(chain_controller&&) = default;
          ~chain_controller();
 
@@ -96,7 +119,7 @@ namespace eos { namespace chain {
             skip_assert_evaluation      = 1 << 8,  ///< used while reindexing
             skip_undo_history_check     = 1 << 9,  ///< used while reindexing
             skip_producer_schedule_check= 1 << 10,  ///< used while reindexing
-            skip_validate               = 1 << 11 ///< used prior to checkpoint, skips validate() call on transaction
+            skip_validate               = 1 << 11 ///< used prior to checkpoint, skips native validate() handlers on transaction
          };
 
          /**
@@ -108,7 +131,8 @@ namespace eos { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
-         const SignedTransaction&   get_recent_transaction( const transaction_id_type& trx_id )const;
+         /// Only available if transaction bodies are stored; @see set_store_transaction_bodies
+         SignedTransaction          get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
          /**
@@ -117,14 +141,59 @@ namespace eos { namespace chain {
           */
          uint32_t producer_participation_rate()const;
 
+         /// @return how the transactions of the most recently generated block were packed into cycles and threads
+         const block_schedule_stats& last_block_schedule_stats()const { return _last_schedule_stats; }
+         /// @return true if the next block generated on the current head can be taken from the candidate block
+         bool candidate_block_ready()const;
+
+         /**
+          * Set whether applied transactions are stored whole in the deduplication index, or only by ID and expiration.
+          * Storing bodies makes @ref get_recent_transaction available, at the cost of shared memory. Defaults to true.
+          */
+         void set_store_transaction_bodies(bool store) { _store_transaction_bodies = store; }
+         bool store_transaction_bodies()const { return _store_transaction_bodies; }
+
+         /**
+          * Set the CPU time a generated block may take to apply. Pending transactions which would take the block over
+          * the budget are postponed to a later block, as are those which would make it too big; a transaction is
+          * only included alone in a block if it exceeds the budget by itself. A budget of zero disables the limit.
+          */
+         void set_block_execution_budget(fc::microseconds budget) { _block_execution_budget = budget; }
+         fc::microseconds block_execution_budget()const { return _block_execution_budget; }
+
+         /// Maps the CPU time a transaction was measured to take to the time charged for it against the budget
+         using cpu_time_charge = std::function<fc::microseconds(fc::microseconds measured)>;
+         /// Set how transactions are charged for CPU time; by default, and if @ref charge is empty, the time measured
+         void set_cpu_time_charge(cpu_time_charge charge) { _cpu_time_charge = std::move(charge); }
+
+         /// @return execution times of the most recently applied transactions, oldest first
+         const deque<transaction_execution_time>& recent_execution_times()const { return _recent_execution_times; }
+
          void                                   add_checkpoints(const flat_map<uint32_t,block_id_type>& checkpts);
          const flat_map<uint32_t,block_id_type> get_checkpoints()const { return _checkpoints; }
          bool before_last_checkpoint()const;
 
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
+         /// Push b, taking the results of the context-free checks from checked rather than repeating them
+         bool push_block( const signed_block& b, const block_prevalidation& checked, uint32_t skip = skip_nothing );
+         /**
+          * Run the checks of b which depend on no chain state -- its ID, transaction merkle root, producer signature and
+          * transaction signatures -- on the thread pool, without taking the write lock. If skip includes
+          * skip_authority_check, b is trusted, and compiling the contract code it sets is started too. b must remain
+          * valid until the returned future is ready.
+          */
+         std::future<block_prevalidation> prevalidate_block( const signed_block& b, uint32_t skip = skip_nothing )const;
+         /**
+          * Push a run of blocks in order, such as a batch received while syncing. The blocks are pipelined: while one
+          * block is applied under the write lock, the blocks after it are prevalidated on the thread pool.
+          *
+          * @return the result of push_block for each block; stops at, and rethrows, the first block which fails
+          */
+         vector<bool> push_blocks( const vector<signed_block>& blocks, uint32_t skip = skip_nothing );
          void push_transaction( const SignedTransaction& trx, uint32_t skip = skip_nothing );
+         void push_transaction( const transaction_metadata& trx, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
-         void _push_transaction( const SignedTransaction& trx );
+         void _push_transaction( const transaction_metadata& trx );
 
          signed_block generate_block(
             fc::time_point_sec when,
@@ -152,13 +221,12 @@ namespace eos { namespace chain {
          auto without_pending_transactions( Function&& f ) -> decltype((*((Function*)nullptr))()) 
          {
             auto old_pending = std::move( _pending_transactions );
+            auto old_head = head_block_id();
             _pending_tx_session.reset();
+            _candidate_block.reset();
+            _permission_cache.clear();
             auto on_exit = fc::make_scoped_exit( [&](){ 
-               for( const auto& t : old_pending ) {
-                  try {
-                     push_transaction( t );
-                  } catch ( ... ){}
-               }
+               restore_pending_transactions( old_pending, old_head );
             });
             return f();
          }
@@ -215,9 +283,48 @@ namespace eos { namespace chain {
 
          uint32_t last_irreversible_block_num() const;
 
+         /**
+          * The state of the head block, published whenever the head block changes. The returned state never changes,
+          * so this may be called from any thread, and never waits for the thread applying blocks.
+          */
+         std::shared_ptr<const head_block_state> get_head_block_state()const {
+            return std::atomic_load(&_head_block_state);
+         }
+
+         /**
+          * Call f holding the database read lock. Blocks and transactions are applied holding the write lock, so f
+          * sees the database as of the head block plus whole pending transactions, never part way through either.
+          * Threads other than the one applying blocks must read the database and fork database only in here.
+          */
+         template<typename Function>
+         auto with_read_lock(Function&& f)const -> decltype(f()) {
+            return _db.with_read_lock(std::forward<Function>(f));
+         }
+
+         const chain_id_type& get_chain_id()const { return _chain_id; }
+
+         /// The cache of keys recovered from transaction signatures, including its hit and miss counts
+         const recovered_key_cache& get_recovered_key_cache()const { return *_recovered_keys; }
+         /// The cache of permissions resolved for authority checks, including its hit and miss counts
+         const permission_cache& get_permission_cache()const { return _permission_cache; }
+
+         /**
+          * Irreversible blocks are written to the block log on a thread of its own. Set how many blocks may be written
+          * between syncs of the log to disk; zero, the default, leaves syncing to the operating system.
+          */
+         void set_block_log_sync_interval(uint32_t blocks) { _block_log_writer->set_sync_interval(blocks); }
+         /**
+          * @return the last block known to have reached the disk. The database is committed no further, so after a
+          * crash it is rewound to at most this block, and the blocks after it are replayed from the block log.
+          */
+         uint32_t last_durable_block_num()const { return _block_log_writer->last_durable_block_num(); }
+         /// Wait for every irreversible block to be written to the block log
+         void flush_block_log() { _block_log_writer->wait(); }
+
    protected:
          const chainbase::database& get_database() const { return _db; }
-         
+         block_log_writer& get_block_log_writer() { return *_block_log_writer; }
+
    private:
 
          /// Reset the object graph in-memory
@@ -227,9 +334,18 @@ namespace eos { namespace chain {
          void replay();
 
          void apply_block(const signed_block& next_block, uint32_t skip = skip_nothing);
-         void apply_transaction(const SignedTransaction& trx, uint32_t skip = skip_nothing);
+         void apply_transaction(const transaction_metadata& trx, uint32_t skip = skip_nothing);
          void _apply_block(const signed_block& next_block);
-         void _apply_transaction(const SignedTransaction& trx);
+         /// The CPU time charged against the block execution budget for a transaction measured to take @ref measured
+         fc::microseconds charged_cpu_time(fc::microseconds measured)const {
+            return _cpu_time_charge? _cpu_time_charge(measured) : measured;
+         }
+         /// @return the time applying trx took, as recorded in @ref recent_execution_times
+         const transaction_execution_time& _apply_transaction(const transaction_metadata& trx);
+
+         /// Verify that no two threads of a cycle touch the same scope, with at least one of them writing it
+         void validate_cycle_scopes(const cycle& c)const;
+         void apply_cycle(const cycle& c);
 
          void require_account(const AccountName& name) const;
 
@@ -237,32 +353,102 @@ namespace eos { namespace chain {
           * This method validates transactions without adding it to the pending state.
           * @return true if the transaction would validate
           */
-         void validate_transaction(const SignedTransaction& trx)const;
+         void validate_transaction(const transaction_metadata& trx)const;
          /// Validate transaction helpers @{
-         void validate_uniqueness(const SignedTransaction& trx)const;
+         void validate_uniqueness(const transaction_metadata& trx)const;
          void validate_tapos(const SignedTransaction& trx)const;
          void validate_referenced_accounts(const SignedTransaction& trx)const;
-         void validate_expiration(const SignedTransaction& trx) const;
+         void validate_referenced_accounts(const types::Message& msg)const;
+         void validate_expiration(const types::Transaction& trx) const;
+         /// Run the validate handlers of m, native and contract; skip_native skips the native ones
+         void validate_message(const Message& m, std::shared_ptr<message_payload_cache> payload, bool skip_native)const;
          /// @}
 
-         void validate_message_precondition(precondition_validate_context& c)const;
-         void process_message(Message message);
-         void apply_message(apply_context& c);
+         /**
+          * Validate a transaction which the contract generator generated while a message was applied. A contract may
+          * only speak for itself, so every message sender and declared authorization must be generator; the messages
+          * must pass their validate handlers and reference existing accounts.
+          */
+         void validate_generated_transaction(const generated_transaction& trx, const AccountName& generator)const;
+
+         /**
+          * Run the native validate() handlers of trx's messages. These handlers see nothing but the message itself, so
+          * this may be called for several transactions concurrently.
+          */
+         void validate_messages_context_free(const transaction_metadata& trx)const;
+
+         /**
+          * Recover the keys which signed each of trxs, spread across the thread pool, into the recovered key cache.
+          * Recovery depends on no chain state, so this is done before taking the write lock.
+          */
+         void recover_signature_keys(const vector<const SignedTransaction*>& trxs)const;
+         /// @return the keys which signed trx over sig_digest, taken from the recovered key cache when possible
+         flat_set<public_key_type> get_signature_keys(const SignedTransaction& trx, const digest_type& sig_digest)const;
+         /// Assert that trx declares an authorization of each message sender, and that keys satisfy every one it declares
+         void check_authorization(const SignedTransaction& trx, const flat_set<public_key_type>& keys)const;
+         /**
+          * Start compiling, in the background, the contract code set by any SetCode messages in trx, unless trx is
+          * not @ref authorized and fails the authority check against the current state
+          */
+         void precompile_contracts(const SignedTransaction& trx, bool authorized)const;
+         /// Start compiling the contract code set by the transactions of block, as above
+         void precompile_contracts(const signed_block& block, bool authorized)const;
+         const message_validate_handler* find_validate_handler(const AccountName& contract, const TypeName& type)const;
+
+         /**
+          * Rebuild the pending state on top of the new head after @ref without_pending_transactions set it aside.
+          *
+          * Transactions which made it into a block, or which have expired, are dropped. If the new head extends the
+          * old one, transactions which touch none of the scopes written by the new blocks are re-applied without
+          * repeating the checks whose outcome cannot have changed; the rest are pushed again from scratch.
+          */
+         void restore_pending_transactions(const deque<transaction_metadata>& old_pending,
+                                           const block_id_type& old_head);
+
+         /// @param native the native handlers for c, as found in _message_handlers; may be null
+         void validate_message_precondition(precondition_validate_context& c, const message_handlers* native)const;
+         /// @param payload decoded message data to share with the message's other handlers; a fresh cache if null
+         void process_message(const Message& message, std::shared_ptr<message_payload_cache> payload = nullptr);
+         /// @param native the native handlers for c, as found in _message_handlers; may be null
+         void apply_message(apply_context& c, const message_handlers* native);
+         /// Queue the transactions generated by the contracts of source, which has just been applied
+         void queue_generated_transactions(const transaction_id_type& source);
+         /// Dequeue and apply a generated transaction, queueing the transactions it generates in turn
+         void apply_generated_transaction(const generated_transaction_id_type& id);
 
          bool should_check_for_duplicate_transactions()const { return !(_skip_flags&skip_transaction_dupe_check); }
          bool should_check_tapos()const                      { return !(_skip_flags&skip_tapos_check);            }
+         bool should_check_authorization()const              { return !(_skip_flags&skip_authority_check);        }
 
          ///Steps involved in applying a new block
          ///@{
-         const producer_object& validate_block_header(uint32_t skip, const signed_block& next_block)const;
+         /// @param signee the key which signed next_block, if already known
+         const producer_object& validate_block_header(uint32_t skip, const signed_block& next_block,
+                                                      const optional<public_key_type>& signee = {})const;
          const producer_object& _validate_block_header(const signed_block& next_block)const;
+         /// The work of prevalidate_block, done on the calling thread
+         block_prevalidation prevalidate(const signed_block& b, uint32_t skip)const;
          void create_block_summary(const signed_block& next_block);
 
          void update_global_properties(const signed_block& b);
          void update_global_dynamic_data(const signed_block& b);
          void update_signing_producer(const producer_object& signing_producer, const signed_block& new_block);
          void update_last_irreversible_block();
+         /**
+          * Rebuild the pending state by applying the pending transactions afresh, scheduling those which fit in a block
+          * into cycles
+          */
+         block_schedule_stats apply_pending_transactions(vector<cycle>& cycles);
+         /// Add trx, just pushed onto the pending transactions, to the candidate block
+         void update_candidate_block(const transaction_metadata& trx, fc::microseconds execution_time);
+         /// Publish the state of the current head block for @ref get_head_block_state
+         void publish_head_block_state();
+         /// Drop the IDs of blocks numbered above block_num from @ref _branch_block_ids
+         void truncate_branch_block_ids(uint32_t block_num);
+
          void clear_expired_transactions();
+         /// Fill the filter of recent transaction IDs from the deduplication index
+         void initialize_transaction_filter();
          /// @}
 
          void spinup_db();
@@ -273,21 +459,76 @@ namespace eos { namespace chain {
          database&                        _db;
          fork_database&                   _fork_db;
          block_log&                       _block_log;
+         unique_ptr<block_log_writer>     _block_log_writer;
 
          unique_ptr<chain_administration_interface> _admin;
+         chain_id_type                    _chain_id;
+         unique_ptr<recovered_key_cache>  _recovered_keys;
+         /// Permissions resolved for authority checks; cleared whenever permissions may have changed
+         mutable permission_cache         _permission_cache;
+         /// Front for the deduplication index; holds at least every transaction ID in it
+         transaction_id_filter            _known_transactions;
+
+         /**
+          * IDs of the blocks on the current branch which are not yet in the block log, in order of block number, so that
+          * @ref fetch_block_by_number can find reversible blocks in the fork database without walking back from its head.
+          * Block IDs embed the block number, so the number of the first is known from the ID itself.
+          */
+         deque<block_id_type>             _branch_block_ids;
 
          optional<database::session>      _pending_tx_session;
-         deque<SignedTransaction>         _pending_transactions;
+         deque<transaction_metadata>      _pending_transactions;
 
          bool                             _pushing  = false;
+         bool                             _store_transaction_bodies = true;
+         fc::microseconds                 _block_execution_budget = fc::milliseconds(config::DefaultBlockExecutionBudgetMs);
+         cpu_time_charge                  _cpu_time_charge;
          uint64_t                         _skip_flags = 0;
 
          flat_map<uint32_t,block_id_type> _checkpoints;
 
-         typedef pair<AccountName,TypeName> handler_key;
-         map< AccountName, map<handler_key, message_validate_handler> >        message_validate_handlers;
-         map< AccountName, map<handler_key, precondition_validate_handler> >   precondition_validate_handlers;
-         map< AccountName, map<handler_key, apply_handler> >                   apply_handlers;
+         block_schedule_stats             _last_schedule_stats;
+
+         deque<transaction_execution_time> _recent_execution_times;
+         /// Only accessed with std::atomic_load and std::atomic_store; readers may hold on to old states
+         std::shared_ptr<const head_block_state> _head_block_state;
+         /// CPU time spent in the WASM interpreter by this controller, ever; it only grows
+         mutable fc::microseconds         _wasm_time;
+
+         /**
+          * A block built up from the pending transactions as they are pushed. If, when the slot arrives, the candidate
+          * holds every pending transaction and was built on the current head, the pending state is exactly the state the
+          * block produces, and generating the block need not apply the transactions again.
+          */
+         struct candidate_block {
+            candidate_block(const block_id_type& previous, size_t max_threads_per_cycle, size_t header_size)
+               : previous(previous), scheduler(cycles, max_threads_per_cycle), size(header_size) {}
+
+            block_id_type         previous;
+            vector<cycle>         cycles;
+            transaction_scheduler scheduler;
+            size_t                size;
+            size_t                transactions = 0;
+            fc::microseconds      execution_time;
+            /// False once a pending transaction had to be left out of the block
+            bool                  complete = true;
+         };
+         unique_ptr<candidate_block>      _candidate_block;
+         /// Whether generated transactions were queued when the pending state was started on the head block
+         bool                             _generated_transactions_at_head = false;
+         /// Transactions generated by the contracts of the transaction being applied, waiting to be queued
+         vector<generated_transaction>    _generated_transactions;
+
+         /// Set while pushing or replaying a block whose context-free checks were done by prevalidate
+         const block_prevalidation*       _prevalidation = nullptr;
+
+         message_handler_table            _message_handlers;
+
+         /// Declared last, so that tasks left on the pool finish before any member they refer to is destroyed
+         unique_ptr<thread_pool>          _thread_pool;
    };
 
 } }
+
+FC_REFLECT(eos::chain::head_block_state, (head_block_num)(head_block_id)(head_block_time)(head_block_producer)
+           (recent_slots_filled)(last_irreversible_block_num))
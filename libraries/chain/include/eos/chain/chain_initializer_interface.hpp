@@ -23,6 +23,8 @@ public:
    virtual BlockchainConfiguration get_chain_start_configuration() = 0;
    /// Retrieve the first round of block producers
    virtual std::array<AccountName, config::BlocksPerRound> get_chain_start_producers() = 0;
+   /// Retrieve the ID of the chain, which transaction signatures commit to
+   virtual chain_id_type get_chain_id() = 0;
 
    /**
     * @brief Install necessary indices and message handlers that chain_controller doesn't know about
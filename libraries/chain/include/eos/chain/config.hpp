@@ -62,6 +62,28 @@ const static int MaxProducerVotes = 30;
 const static UInt128 ProducerRaceLapLength = std::numeric_limits<UInt128>::max();
 
 const static auto StakedBalanceCooldownSeconds = fc::days(3).to_seconds();
+
+/** Number of recovered signature keys the chain_controller keeps around for transactions validated again */
+const static int RecoveredKeyCacheSize = 64 * 1024;
+/** Span of expiration times covered by each bloom filter of recently applied transaction IDs */
+const static int TransactionFilterWindowSeconds = 10 * 60;
+/** Number of transactions each bloom filter of recent transaction IDs is sized for, and its target error rate */
+const static int TransactionFilterWindowSize = 256 * 1024;
+const static double TransactionFilterFalsePositiveRate = 0.001;
+/** Number of blocks the block log reader may get ahead of the blocks being applied during a replay */
+const static int ReplayQueueSize = 256;
+/** Number of irreversible blocks which may wait to be written to the block log before block application waits */
+const static int BlockLogQueueSize = 1024;
+/** CPU time, in milliseconds, a producer may spend applying the transactions of a block it generates */
+const static int DefaultBlockExecutionBudgetMs = 1000;
+/** Number of applied transactions whose execution times the chain_controller keeps */
+const static int ExecutionTimeHistorySize = 1024;
+/** Number of account permissions an authority may nest through before the deeper ones stop counting */
+const static int MaxAuthorityDepth = 6;
+/** Number of contracts which may wait to be compiled in the background; others are compiled when first loaded */
+const static int MaxPendingPrecompiles = 16;
+/** Number of compiled contracts whose machine code is kept in memory, in front of the code cache on disk */
+const static int CompiledContractCacheSize = 256;
 } } // namespace eos::config
 
 template<typename Number>
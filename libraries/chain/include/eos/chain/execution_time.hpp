@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/types.hpp>
+
+#include <fc/time.hpp>
+
+namespace eos { namespace chain {
+
+   /// @return CPU time consumed so far by the calling thread
+   fc::microseconds thread_cpu_time();
+
+   /// Measures the wall clock and calling thread's CPU time elapsed since construction
+   class execution_timer {
+      public:
+         execution_timer() : _wall_start(fc::time_point::now()), _cpu_start(thread_cpu_time()) {}
+
+         fc::microseconds wall()const { return fc::time_point::now() - _wall_start; }
+         fc::microseconds cpu()const { return thread_cpu_time() - _cpu_start; }
+
+      private:
+         fc::time_point   _wall_start;
+         fc::microseconds _cpu_start;
+   };
+
+   /// Time spent processing a message, over its recipient and every notified account
+   struct message_execution_time {
+      AccountName      recipient;
+      TypeName         type;
+      fc::microseconds wall;
+      fc::microseconds cpu;
+      /// Part of cpu spent in contract code run by the WASM interpreter
+      fc::microseconds wasm;
+   };
+
+   /// Time spent applying a transaction, from validation through writing it to the deduplication index
+   struct transaction_execution_time {
+      transaction_id_type            id;
+      fc::microseconds               wall;
+      fc::microseconds               cpu;
+      fc::microseconds               wasm;
+      vector<message_execution_time> messages;
+   };
+
+} } // eos::chain
+
+FC_REFLECT(eos::chain::message_execution_time, (recipient)(type)(wall)(cpu)(wasm))
+FC_REFLECT(eos::chain::transaction_execution_time, (id)(wall)(cpu)(wasm)(messages))
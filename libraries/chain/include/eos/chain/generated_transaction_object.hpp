@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <fc/io/raw.hpp>
+
+#include <eos/chain/transaction.hpp>
+
+#include <boost/multi_index/hashed_index.hpp>
+
+#include "multi_index_includes.hpp"
+
+namespace eos { namespace chain {
+   using boost::multi_index_container;
+   using namespace boost::multi_index;
+   /**
+    * A generated_transaction_object is a transaction generated by a contract which waits to be included in a block.
+    *
+    * Applying a transaction queues the transactions its contracts generated, and the producer of a later block pulls
+    * them, earliest deadline first, into the block's @ref thread::generated_input by ID. Applying that block executes
+    * and dequeues them. A generated transaction which is not included by its expiration is dropped.
+    *
+    * The transaction is kept packed, as the block references it only by ID and it is unpacked once, to be applied.
+    */
+   class generated_transaction_object : public chainbase::object<generated_transaction_object_type,
+                                                                 generated_transaction_object>
+   {
+         OBJECT_CTOR(generated_transaction_object, (packed_trx))
+
+         id_type                       id;
+         generated_transaction_id_type trx_id;
+         time_point_sec                expiration;
+         shared_string                 packed_trx; ///< The packed Transaction
+   };
+
+   struct by_trx_id;
+   struct by_expiration;
+   using generated_transaction_multi_index = chainbase::shared_multi_index_container<
+      generated_transaction_object,
+      indexed_by<
+         ordered_unique<tag<by_id>, BOOST_MULTI_INDEX_MEMBER(generated_transaction_object, generated_transaction_object::id_type, id)>,
+         hashed_unique<tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(generated_transaction_object, generated_transaction_id_type, trx_id), std::hash<generated_transaction_id_type>>,
+         ordered_unique<tag<by_expiration>,
+            composite_key<generated_transaction_object,
+               BOOST_MULTI_INDEX_MEMBER(generated_transaction_object, time_point_sec, expiration),
+               BOOST_MULTI_INDEX_MEMBER(generated_transaction_object, generated_transaction_object::id_type, id)
+            >
+         >
+      >
+   >;
+
+   typedef chainbase::generic_index<generated_transaction_multi_index> generated_transaction_index;
+} }
+
+CHAINBASE_SET_INDEX_TYPE(eos::chain::generated_transaction_object, eos::chain::generated_transaction_multi_index)
+
+FC_REFLECT( eos::chain::generated_transaction_object, (trx_id)(expiration) )
@@ -2,6 +2,9 @@
 
 #include <eos/chain/types.hpp>
 
+#include <memory>
+#include <typeinfo>
+
 namespace eos { namespace chain {
 
 /**
@@ -54,7 +57,41 @@ struct Message : public types::Message {
    }
 };
 
+/**
+ * @brief Holds the decoded payload of a message so that it is unpacked only once
+ *
+ * A message is handled by validate, precondition and apply handlers for its recipient and for every notified account,
+ * and each of them needs the payload as a struct. All of those handlers share one cache, so the first to ask for the
+ * payload unpacks it and the rest get a reference to the same object.
+ *
+ * Handlers almost always decode a message as a single type, but nothing requires it, so a value is kept for each type
+ * requested. The cache is not thread safe; a message is only handled by one thread at a time.
+ */
+class message_payload_cache {
+public:
+   template<typename T>
+   const T& get(const Message& m) {
+      for (const auto& v : values)
+         if (v->type() == typeid(T))
+            return static_cast<const value<T>&>(*v).decoded;
+      values.emplace_back(new value<T>(m.as<T>()));
+      return static_cast<const value<T>&>(*values.back()).decoded;
+   }
+
+private:
+   struct value_base {
+      virtual ~value_base() {}
+      virtual const std::type_info& type()const = 0;
+   };
+   template<typename T>
+   struct value : value_base {
+      explicit value(T&& v) : decoded(std::move(v)) {}
+      const std::type_info& type()const override { return typeid(T); }
+      T decoded;
+   };
 
+   vector<std::unique_ptr<value_base>> values;
+};
 
 } } // namespace eos::chain
 
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <eos/chain/message_handling_contexts.hpp>
+#include <eos/chain/types.hpp>
+
+namespace eos { namespace chain {
+
+/// The native handlers for one (contract, scope, type); any of them may be empty
+struct message_handlers {
+   message_validate_handler      validate;
+   precondition_validate_handler precondition;
+   apply_handler                 apply;
+};
+
+/**
+ * @brief Maps (contract, scope, type) to the native handlers for messages of that type
+ *
+ * Every handler of every message is looked up here, so lookups are what this table is built for. Handlers are all
+ * registered at startup, after which the table is frozen into an open-addressed hash table: the hash of the packed key
+ * picks a slot, and collisions are resolved by linear probing. The table is kept no more than half full, so a lookup
+ * usually touches one slot, and a single lookup returns the handlers for all three phases.
+ */
+class message_handler_table {
+public:
+   /// Get the handlers for a key, adding an empty entry if there is none yet. Not allowed once frozen.
+   message_handlers& at(const AccountName& contract, const AccountName& scope, const TypeName& type);
+
+   /// Build the lookup table. No handlers may be added afterward.
+   void freeze();
+   bool frozen()const { return _frozen; }
+
+   /// @return the handlers for the key, or nullptr if there are none or the table has not been frozen yet
+   const message_handlers* find(const AccountName& contract, const AccountName& scope, const TypeName& type)const;
+
+   size_t size()const { return _entries.size(); }
+
+private:
+   struct key_type {
+      AccountName contract;
+      AccountName scope;
+      TypeName    type;
+   };
+   struct entry {
+      key_type         key;
+      message_handlers handlers;
+   };
+   struct slot {
+      uint64_t hash  = 0;
+      uint32_t index = 0; ///< one more than the index of the entry in _entries; zero for an empty slot
+   };
+
+   static key_type make_key(const AccountName& contract, const AccountName& scope, const TypeName& type);
+   static uint64_t hash(const key_type& key);
+   static bool equal(const key_type& a, const key_type& b);
+
+   vector<entry> _entries;
+   vector<slot>  _slots;
+   uint64_t      _mask = 0;
+   bool          _frozen = false;
+};
+
+} } // namespace eos::chain
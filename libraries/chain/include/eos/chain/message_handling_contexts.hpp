@@ -10,24 +10,37 @@ namespace eos { namespace chain {
 
 class message_validate_context {
 public:
-   explicit message_validate_context(const chainbase::database& d, const chain::Message& m, types::AccountName s)
-      :msg(m),db(d),scope(s){}
+   explicit message_validate_context(const chainbase::database& d, const chain::Message& m, types::AccountName s,
+                                     std::shared_ptr<message_payload_cache> p = nullptr)
+      :msg(m),db(d),scope(s),payload(p? std::move(p) : std::make_shared<message_payload_cache>()){}
+
+   /**
+    * @brief Get the message's data decoded as T
+    *
+    * Native handlers should prefer this to msg.as<T>(): every context created for the same message shares the decoded
+    * value, so the data is unpacked once however many handlers read it.
+    */
+   template<typename T>
+   const T& msg_as()const { return payload->get<T>(msg); }
 
    const chain::Message&        msg;
    const chainbase::database&   db;    /// required only for loading the contract code
    types::AccountName           scope; /// the contract that is being called
+   std::shared_ptr<message_payload_cache> payload; /// decoded data, shared with other contexts for msg
 };
 
 class precondition_validate_context : public message_validate_context {
 public:
-   precondition_validate_context(const chainbase::database& db, const chain::Message& m, const types::AccountName& scope)
-      :message_validate_context(db, m, scope){}
+   precondition_validate_context(const chainbase::database& db, const chain::Message& m, const types::AccountName& scope,
+                                 std::shared_ptr<message_payload_cache> payload = nullptr)
+      :message_validate_context(db, m, scope, std::move(payload)){}
 };
 
 class apply_context : public precondition_validate_context {
 public:
-   apply_context(chainbase::database& db, const chain::Message& m, const types::AccountName& scope)
-      :precondition_validate_context(db,m,scope),mutable_db(db){}
+   apply_context(chainbase::database& db, const chain::Message& m, const types::AccountName& scope,
+                 std::shared_ptr<message_payload_cache> payload = nullptr)
+      :precondition_validate_context(db,m,scope,std::move(payload)),mutable_db(db){}
 
    types::String get(types::String key)const;
    void set(types::String key, types::String value);
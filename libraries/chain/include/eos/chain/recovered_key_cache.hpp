@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/types.hpp>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief A bounded, least-recently-used cache of public keys recovered from signatures
+    *
+    * The same transaction is typically validated several times: when it is first pushed, when pending state is
+    * rebuilt after a block, when a block is generated, and when the block is applied. Each validation needs the keys
+    * which signed it, and secp256k1 recovery is by far the most expensive part of that. This cache reduces repeat
+    * recoveries to a hash lookup.
+    *
+    * Entries are keyed on both the signed digest and the signature. The cache may be used from several threads at
+    * once; recovery on a miss happens outside the lock.
+    */
+   class recovered_key_cache {
+      public:
+         explicit recovered_key_cache(size_t capacity);
+
+         /// @return the key which produced sig over digest
+         public_key_type recover(const digest_type& digest, const signature_type& sig);
+
+         size_t   capacity()const { return _capacity; }
+         size_t   size()const;
+         uint64_t hits()const   { return _hits.load(std::memory_order_relaxed); }
+         uint64_t misses()const { return _misses.load(std::memory_order_relaxed); }
+
+      private:
+         struct cache_key {
+            digest_type    digest;
+            signature_type signature;
+
+            bool operator==(const cache_key& other)const {
+               return digest == other.digest && signature == other.signature;
+            }
+         };
+         struct cache_key_hash {
+            size_t operator()(const cache_key& k)const;
+         };
+         using lru_list = std::list<std::pair<cache_key, public_key_type>>;
+
+         const size_t                                                        _capacity;
+         mutable std::mutex                                                  _mutex;
+         lru_list                                                            _lru;
+         std::unordered_map<cache_key, lru_list::iterator, cache_key_hash>   _index;
+         std::atomic<uint64_t>                                               _hits{0};
+         std::atomic<uint64_t>                                               _misses{0};
+   };
+
+} } // eos::chain
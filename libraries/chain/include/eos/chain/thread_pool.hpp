@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <boost/asio/io_service.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief A fixed set of worker threads servicing a shared queue of tasks
+    *
+    * The pool is used by @ref chain_controller to spread work which does not mutate chain state (validation, signature
+    * recovery, hashing) across all available cores. Tasks posted to the pool may read the database only while the
+    * posting thread guarantees that no writer is active.
+    */
+   class thread_pool {
+      public:
+         /// hardware_concurrency() may be 0 when it cannot be determined; the pool always has at least one worker
+         explicit thread_pool(size_t num_threads = std::max<size_t>(1, std::thread::hardware_concurrency()));
+         thread_pool(const thread_pool&) = delete;
+         ~thread_pool();
+
+         /// @return the number of worker threads, not counting the threads which post work to the pool
+         size_t size()const { return _workers.size(); }
+
+         /**
+          * Queue f for execution on one of the workers
+          * @return a future which will hold the result of f, or the exception it threw
+          */
+         template<typename Function>
+         auto post(Function&& f) -> std::future<decltype(f())> {
+            using result_type = decltype(f());
+            auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Function>(f));
+            auto result = task->get_future();
+            _ios.post([task] { (*task)(); });
+            return result;
+         }
+
+         /**
+          * Invoke f(i) for every i in [0, count), split into contiguous chunks across the workers, and wait for all
+          * invocations to complete. The calling thread processes the first chunk itself.
+          *
+          * If any invocation throws, the remaining chunks still run to completion and the exception from the lowest
+          * chunk is rethrown. Must not be called from a task running on this pool.
+          */
+         template<typename Function>
+         void for_each(size_t count, Function&& f) {
+            if (count == 0)
+               return;
+
+            const size_t chunks = std::min(count, _workers.size() + 1);
+            const size_t chunk_size = (count + chunks - 1) / chunks;
+            auto run_chunk = [&f, count, chunk_size](size_t chunk) {
+               for (size_t i = chunk * chunk_size; i < std::min(count, (chunk + 1) * chunk_size); ++i)
+                  f(i);
+            };
+
+            std::vector<std::future<void>> pending;
+            pending.reserve(chunks - 1);
+            for (size_t chunk = 1; chunk < chunks; ++chunk)
+               pending.emplace_back(post([&run_chunk, chunk] { run_chunk(chunk); }));
+
+            std::exception_ptr error;
+            try {
+               run_chunk(0);
+            } catch (...) {
+               error = std::current_exception();
+            }
+            for (auto& p : pending) {
+               try {
+                  p.get();
+               } catch (...) {
+                  if (!error) error = std::current_exception();
+               }
+            }
+            if (error)
+               std::rethrow_exception(error);
+         }
+
+      private:
+         boost::asio::io_service                                _ios;
+         std::unique_ptr<boost::asio::io_service::work>         _work;
+         std::vector<std::thread>                               _workers;
+   };
+
+} } // eos::chain
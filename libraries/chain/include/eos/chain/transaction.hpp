@@ -69,6 +69,12 @@ namespace eos { namespace chain {
       generated_transaction_id_type id;
 
       digest_type merkle_digest() const;
+
+      /// The scopes the transaction reads and writes, as for @ref SignedTransaction::read_scope
+      ///@{
+      flat_set<AccountName> read_scope()const;
+      flat_set<AccountName> write_scope()const;
+      ///@}
    };
 
    /**
@@ -97,6 +103,16 @@ namespace eos { namespace chain {
 
       flat_set<public_key_type> get_signature_keys(const chain_id_type& chain_id)const;
 
+      /**
+       * The scopes a transaction may write are those of the accounts whose handlers run in an @ref apply_context: the
+       * recipient and notified accounts of each message. Senders are only read. Two transactions whose scopes do not
+       * overlap in this sense can be applied in either order, or concurrently, with the same result.
+       */
+      ///@{
+      flat_set<AccountName> read_scope()const;
+      flat_set<AccountName> write_scope()const;
+      ///@}
+
       template <typename T>
       void setMessage(int messageIndex, const TypeName& type, T&& value) {
          Message m(messages[messageIndex]);
@@ -120,11 +136,50 @@ namespace eos { namespace chain {
       void clear() { messages.clear(); signatures.clear(); authorizations.clear(); }
 
       digest_type merkle_digest()const;
+
+      /// Derive the transaction ID from the transaction's @ref digest
+      static transaction_id_type id_from_digest(const digest_type& digest);
+   };
+
+   /**
+    * @brief A SignedTransaction along with its serialization and the values derived from it
+    *
+    * The chain needs a transaction's ID, digest and size several times over while validating it, applying it and
+    * packing it into a block, and each of those used to repack and rehash the whole transaction. transaction_metadata
+    * computes them once, when the transaction enters the node, so they can be passed along with it. Likewise, each
+    * message's decoded payload is cached here, so it is not unpacked again when the transaction is reapplied.
+    *
+    * The packed form of a SignedTransaction begins with the packed form of its Transaction, so the digests are taken
+    * over a prefix of the packed bytes without serializing again.
+    */
+   class transaction_metadata {
+      public:
+         explicit transaction_metadata(SignedTransaction trx);
+
+         const SignedTransaction&   trx()const         { return _trx; }
+         const transaction_id_type& id()const          { return _id; }
+         /// @see SignedTransaction::digest
+         const digest_type&         digest()const      { return _digest; }
+         /// @see SignedTransaction::sig_digest
+         digest_type                sig_digest(const chain_id_type& chain_id)const;
+         const vector<char>&        packed()const      { return _packed; }
+         size_t                     packed_size()const { return _packed.size(); }
+         /// The decoded payload of trx().messages[i], shared by all of the message's handlers
+         const std::shared_ptr<message_payload_cache>& payload(size_t i)const { return _payloads[i]; }
+
+      private:
+         SignedTransaction   _trx;
+         vector<char>        _packed;
+         /// Length of the packed Transaction at the start of _packed
+         size_t              _transaction_size;
+         digest_type         _digest;
+         transaction_id_type _id;
+         vector<std::shared_ptr<message_payload_cache>> _payloads;
    };
 
    /// @} transactions group
 
 } } // eos::chain
 
-FC_REFLECT(eos::chain::generated_transaction, (id))
+FC_REFLECT_DERIVED(eos::chain::generated_transaction, (eos::types::Transaction), (id))
 FC_REFLECT_DERIVED(eos::chain::SignedTransaction, (eos::types::SignedTransaction), )
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <eos/chain/types.hpp>
+
+#include <fc/bloom_filter.hpp>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief A probabilistic set of recently applied transaction IDs, to rule out duplicates cheaply
+    *
+    * Nearly every transaction checked for uniqueness is new, and proving so takes a probe of the deduplication index in
+    * chainbase. This filter answers "definitely never seen" for most of them without touching the index; only a
+    * "maybe" needs to be confirmed against it.
+    *
+    * IDs are kept in a series of bloom filters, one per window of expiration times. A transaction cannot be applied
+    * after it expires, so once a window lies wholly in the past its filter can be dropped in one step instead of the
+    * filter growing forever. The filter is never told about undone transactions; it only has to contain every
+    * transaction in the index, so stale entries cost nothing but the occasional false positive.
+    */
+   class transaction_id_filter {
+      public:
+         /**
+          * @param window_seconds the span of expiration times covered by each filter
+          * @param expected_per_window the number of transactions each filter is sized for
+          * @param false_positive_rate the target false positive rate of each filter, when holding expected_per_window IDs
+          */
+         transaction_id_filter(uint32_t window_seconds, uint64_t expected_per_window, double false_positive_rate);
+
+         void insert(const transaction_id_type& id, time_point_sec expiration);
+         /// @return false if id was certainly not inserted in a window still kept; true if it may have been
+         bool may_contain(const transaction_id_type& id)const;
+         /// Drop the filters of all windows which end at or before time
+         void expire(time_point_sec time);
+         void clear() { _windows.clear(); }
+
+         size_t window_count()const { return _windows.size(); }
+         /// @return the end of the earliest window still kept, or time_point_sec::maximum() if there is none
+         time_point_sec earliest_window_end()const;
+
+      private:
+         struct window {
+            uint32_t          start;
+            fc::bloom_filter  filter;
+         };
+
+         uint32_t              _window_seconds;
+         fc::bloom_parameters  _parameters;
+         /// Ordered by start
+         deque<window>         _windows;
+   };
+
+} } // eos::chain
@@ -28,7 +28,6 @@
 #include <fc/uint128.hpp>
 
 #include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/mem_fun.hpp>
 
 #include "multi_index_includes.hpp"
 
@@ -39,16 +38,18 @@ namespace eos { namespace chain {
     * The purpose of this object is to enable the detection of duplicate transactions. When a transaction is included
     * in a block a transaction_object is added. At the end of block processing all transaction_objects that have
     * expired can be removed from the index.
+    *
+    * Only the ID and expiration are needed for that, so the transaction itself is kept, packed, only if the
+    * chain_controller is configured to store transaction bodies (see @ref chain_controller::set_store_transaction_bodies).
     */
    class transaction_object : public chainbase::object<transaction_object_type, transaction_object>
    {
-         OBJECT_CTOR(transaction_object)
+         OBJECT_CTOR(transaction_object, (packed_trx))
 
          id_type             id;
-         SignedTransaction  trx;
          transaction_id_type trx_id;
-
-         time_point_sec get_expiration()const { return trx.expiration; }
+         time_point_sec      expiration;
+         shared_string       packed_trx; ///< The packed SignedTransaction, or empty if bodies are not stored
    };
 
    struct by_expiration;
@@ -58,7 +59,7 @@ namespace eos { namespace chain {
       indexed_by<
          ordered_unique<tag<by_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_object::id_type, id)>,
          hashed_unique<tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_id_type, trx_id), std::hash<transaction_id_type>>,
-         ordered_non_unique<tag<by_expiration>, const_mem_fun<transaction_object, time_point_sec, &transaction_object::get_expiration>>
+         ordered_non_unique<tag<by_expiration>, BOOST_MULTI_INDEX_MEMBER(transaction_object, time_point_sec, expiration)>
       >
    >;
 
@@ -67,4 +68,4 @@ namespace eos { namespace chain {
 
 CHAINBASE_SET_INDEX_TYPE(eos::chain::transaction_object, eos::chain::transaction_multi_index)
 
-FC_REFLECT( eos::chain::transaction_object, (trx)(trx_id) )
+FC_REFLECT( eos::chain::transaction_object, (trx_id)(expiration) )
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/block.hpp>
+
+namespace eos { namespace chain {
+
+   /// Parallelism of the cycles and threads in a generated block
+   struct block_schedule_stats {
+      uint32_t transactions = 0;
+      uint32_t cycles = 0;
+      uint32_t threads = 0;
+      /// Largest number of threads in a single cycle
+      uint32_t max_threads_per_cycle = 0;
+      /// Sum over all cycles of the number of transactions in the cycle's longest thread
+      uint32_t critical_path = 0;
+   };
+
+   /**
+    * @brief Packs transactions into the cycles and threads of a block
+    *
+    * Transactions are scheduled greedily in the order given. A transaction which conflicts (see
+    * @ref SignedTransaction::write_scope) with exactly one thread of the current cycle is appended to that thread. One
+    * which conflicts with no thread starts a new thread, or joins the shortest thread once the cycle holds
+    * max_threads_per_cycle threads. One which conflicts with several threads cannot be placed in the current cycle,
+    * so it starts a new cycle.
+    *
+    * Applying the resulting cycles gives the same result as applying the transactions serially in the order given.
+    */
+   class transaction_scheduler {
+      public:
+         transaction_scheduler(vector<cycle>& cycles, size_t max_threads_per_cycle);
+
+         void schedule(const SignedTransaction& trx);
+
+         block_schedule_stats stats()const;
+
+      private:
+         struct thread_scope {
+            flat_set<AccountName> reads;
+            flat_set<AccountName> writes;
+         };
+
+         void start_cycle();
+
+         vector<cycle>&       _cycles;
+         /// Accumulated scopes of the threads in the last cycle
+         vector<thread_scope> _scopes;
+         size_t               _max_threads;
+   };
+
+} } // eos::chain
+
+FC_REFLECT(eos::chain::block_schedule_stats, (transactions)(cycles)(threads)(max_threads_per_cycle)(critical_path))
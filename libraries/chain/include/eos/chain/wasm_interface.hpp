@@ -1,6 +1,8 @@
 #pragma once
 #include <eos/chain/message.hpp>
 #include <eos/chain/message_handling_contexts.hpp>
+#include <memory>
+#include <unordered_map>
 #include <Runtime/Runtime.h>
 #include "IR/Module.h"
 
@@ -11,20 +13,61 @@ class  chain_controller;
 /**
  * @class wasm_interface
  *
- * EOS uses the wasm-jit library to evaluate web assembly code. This library relies
- * upon a singlton interface which means there can be only one instance. This interface
- * is designed to wrap that singlton interface and potentially make it thread-local state
- * in the future.
+ * EOS uses the wasm-jit library to evaluate web assembly code. Each thread has its own
+ * instance of this interface, with its own instances of contracts and the context of the
+ * message being processed, so that several threads may run contracts at once. The code
+ * of contracts, once deserialized and compiled, is shared by all threads.
  */
 class wasm_interface {
    public:
+      /// @return the calling thread's instance
       static wasm_interface& get();
+      ~wasm_interface();
 
       void init( apply_context& c );
       void apply( apply_context& c );
       void validate( message_validate_context& c );
       void precondition( precondition_validate_context& c );
 
+      /// Cache the machine code compiled for contracts in @ref dir, keyed by code version, to reuse it across restarts
+      static void set_code_cache_dir( const fc::path& dir );
+
+      /**
+       * Compile @ref code into the code cache in the background, so that it is ready by the time a contract using it
+       * is loaded. Does nothing without a code cache, if the code is being compiled already, or if too many contracts
+       * are waiting to be compiled. Only submit code whose transaction is authorized, or whose block is trusted.
+       * May be called from any thread.
+       */
+      static void precompile( const types::Bytes& code );
+
+      /// The phases of message processing for which a contract may export handlers
+      enum class entry_point : uint8_t {
+         validate,
+         precondition,
+         apply
+      };
+
+      /// Identifies a handler by its phase and the message type and recipient it is exported for
+      struct entry_point_key {
+         entry_point  phase;
+         TypeName     type;
+         AccountName  recipient;
+
+         bool operator==( const entry_point_key& other )const {
+            return phase == other.phase && type == other.type && recipient == other.recipient;
+         }
+      };
+      struct entry_point_key_hash {
+         size_t operator()( const entry_point_key& k )const;
+      };
+      using entry_point_table = std::unordered_map<entry_point_key, Runtime::FunctionInstance*, entry_point_key_hash>;
+
+      /**
+       * Resolve the handlers exported by an instantiated contract, named like onApply_<type>_<recipient>, so that
+       * dispatching a message doesn't need to look up an export by name
+       */
+      static entry_point_table find_entry_points( const IR::Module& module, Runtime::ModuleInstance* instance );
+
       apply_context*                  current_apply_context        = nullptr;
       message_validate_context*       current_validate_context     = nullptr;
       precondition_validate_context*  current_precondition_context = nullptr;
@@ -34,9 +77,11 @@ class wasm_interface {
 
    private:
       void load( const AccountName& name, const chainbase::database& db );
+      /// Block until a background compilation of the code with @ref code_version, if any, has finished
+      static void wait_for_precompile( const fc::sha256& code_version );
 
       char* vm_allocate( int bytes );   
-      void  vm_call( std::string name );
+      void  vm_call( entry_point phase );
       void  vm_validate();
       void  vm_precondition();
       void  vm_apply();
@@ -45,13 +90,16 @@ class wasm_interface {
 
 
       struct ModuleState {
-         Runtime::ModuleInstance* instance = nullptr;
-         IR::Module*              module   = nullptr;
-         vector<char>             init_memory;
-         fc::sha256               code_version;
+         Runtime::ModuleInstance*          instance    = nullptr;
+         std::shared_ptr<const IR::Module> module; ///< shared with the other threads running this code
+         Runtime::MemorySnapshot*          init_memory = nullptr;
+         fc::sha256                        code_version;
+         entry_point_table                 entry_points;
+         Runtime::FunctionInstance*        on_init     = nullptr; ///< the onInit export, if any
       };
 
       map<AccountName, ModuleState> instances;
+      ModuleState*                  current_state = nullptr; ///< the state of the contract last loaded
 
 
       wasm_interface();
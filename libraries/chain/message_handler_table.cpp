@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/message_handler_table.hpp>
+#include <eos/chain/exceptions.hpp>
+
+#include <fc/crypto/city.hpp>
+
+namespace eos { namespace chain {
+
+message_handlers& message_handler_table::at(const AccountName& contract, const AccountName& scope,
+                                            const TypeName& type) {
+   FC_ASSERT(!_frozen, "Cannot register a message handler after startup",
+             ("contract", contract)("scope", scope)("type", type));
+   auto key = make_key(contract, scope, type);
+   for (auto& e : _entries)
+      if (equal(e.key, key))
+         return e.handlers;
+   _entries.emplace_back(entry{key, {}});
+   return _entries.back().handlers;
+}
+
+void message_handler_table::freeze() {
+   FC_ASSERT(!_frozen, "Message handler table is already frozen");
+   size_t capacity = 16;
+   while (capacity < _entries.size() * 2)
+      capacity <<= 1;
+   _slots.assign(capacity, slot());
+   _mask = capacity - 1;
+
+   for (uint32_t i = 0; i < _entries.size(); ++i) {
+      auto h = hash(_entries[i].key);
+      auto pos = h & _mask;
+      while (_slots[pos].index)
+         pos = (pos + 1) & _mask;
+      _slots[pos].hash = h;
+      _slots[pos].index = i + 1;
+   }
+   _frozen = true;
+}
+
+const message_handlers* message_handler_table::find(const AccountName& contract, const AccountName& scope,
+                                                    const TypeName& type)const {
+   if (!_frozen)
+      return nullptr;
+   auto key = make_key(contract, scope, type);
+   auto h = hash(key);
+   for (auto pos = h & _mask; _slots[pos].index; pos = (pos + 1) & _mask) {
+      const auto& s = _slots[pos];
+      if (s.hash == h) {
+         const auto& e = _entries[s.index - 1];
+         if (equal(e.key, key))
+            return &e.handlers;
+      }
+   }
+   return nullptr;
+}
+
+message_handler_table::key_type message_handler_table::make_key(const AccountName& contract, const AccountName& scope,
+                                                                const TypeName& type) {
+   key_type key;
+   key.contract = contract;
+   key.scope = scope;
+   key.type = type;
+   return key;
+}
+
+uint64_t message_handler_table::hash(const key_type& key) {
+   // Each name is a fixed 32 bytes, so the key packs into one contiguous buffer
+   char packed[sizeof(key.contract.data) + sizeof(key.scope.data) + sizeof(key.type.data)];
+   memcpy(packed, &key.contract.data, sizeof(key.contract.data));
+   memcpy(packed + sizeof(key.contract.data), &key.scope.data, sizeof(key.scope.data));
+   memcpy(packed + sizeof(key.contract.data) + sizeof(key.scope.data), &key.type.data, sizeof(key.type.data));
+   return fc::city_hash64(packed, sizeof(packed));
+}
+
+bool message_handler_table::equal(const key_type& a, const key_type& b) {
+   return a.contract == b.contract && a.scope == b.scope && a.type == b.type;
+}
+
+} } // namespace eos::chain
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/recovered_key_cache.hpp>
+
+#include <cstring>
+
+namespace eos { namespace chain {
+
+size_t recovered_key_cache::cache_key_hash::operator()(const cache_key& k)const {
+   // The digest is already uniformly distributed; mix in the signature so that one digest signed by several keys
+   // does not land in one bucket. The first signature byte only carries the recovery ID, so skip it.
+   uint64_t sig_bits;
+   memcpy(&sig_bits, k.signature.begin() + 1, sizeof(sig_bits));
+   return k.digest._hash[0] ^ sig_bits;
+}
+
+recovered_key_cache::recovered_key_cache(size_t capacity)
+   : _capacity(std::max<size_t>(capacity, 1)) {
+   _index.reserve(_capacity);
+}
+
+size_t recovered_key_cache::size()const {
+   std::lock_guard<std::mutex> lock(_mutex);
+   return _index.size();
+}
+
+public_key_type recovered_key_cache::recover(const digest_type& digest, const signature_type& sig) {
+   cache_key key{digest, sig};
+   {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto itr = _index.find(key);
+      if (itr != _index.end()) {
+         _lru.splice(_lru.begin(), _lru, itr->second);
+         _hits.fetch_add(1, std::memory_order_relaxed);
+         return itr->second->second;
+      }
+   }
+
+   _misses.fetch_add(1, std::memory_order_relaxed);
+   public_key_type result = fc::ecc::public_key(sig, digest);
+
+   std::lock_guard<std::mutex> lock(_mutex);
+   // Another thread may have recovered the same key while we were not holding the lock
+   if (_index.count(key))
+      return result;
+   _lru.emplace_front(key, result);
+   _index.emplace(std::move(key), _lru.begin());
+   if (_index.size() > _capacity) {
+      _index.erase(_lru.back().first);
+      _lru.pop_back();
+   }
+   return result;
+}
+
+} } // eos::chain
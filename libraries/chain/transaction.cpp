@@ -43,9 +43,12 @@ digest_type SignedTransaction::sig_digest( const chain_id_type& chain_id )const
 }
 
 eos::chain::transaction_id_type SignedTransaction::id() const {
-   auto h = digest();
+   return id_from_digest(digest());
+}
+
+transaction_id_type SignedTransaction::id_from_digest(const digest_type& digest) {
    transaction_id_type result;
-   memcpy(result._hash, h._hash, std::min(sizeof(result), sizeof(h)));
+   memcpy(result._hash, digest._hash, std::min(sizeof(result), sizeof(digest)));
    return result;
 }
 
@@ -86,16 +89,68 @@ flat_set<public_key_type> SignedTransaction::get_signature_keys( const chain_id_
    return result;
 } FC_CAPTURE_AND_RETHROW() }
 
+namespace {
+   flat_set<AccountName> messages_read_scope(const vector<types::Message>& messages) {
+      flat_set<AccountName> result;
+      for (const auto& m : messages)
+         result.insert(m.sender);
+      return result;
+   }
+
+   flat_set<AccountName> messages_write_scope(const vector<types::Message>& messages) {
+      flat_set<AccountName> result;
+      for (const auto& m : messages) {
+         result.insert(m.recipient);
+         result.insert(m.notify.begin(), m.notify.end());
+      }
+      return result;
+   }
+}
+
+flat_set<AccountName> SignedTransaction::read_scope()const {
+   return messages_read_scope(messages);
+}
+
+flat_set<AccountName> SignedTransaction::write_scope()const {
+   return messages_write_scope(messages);
+}
+
 eos::chain::digest_type SignedTransaction::merkle_digest() const {
    digest_type::encoder enc;
    fc::raw::pack(enc, static_cast<const types::Transaction&>(*this));
    return enc.result();
 }
 
+transaction_metadata::transaction_metadata(SignedTransaction trx)
+   : _trx(std::move(trx)) {
+   _transaction_size = fc::raw::pack_size(static_cast<const types::Transaction&>(_trx));
+   _packed = fc::raw::pack(_trx);
+   _digest = digest_type::hash(_packed.data(), _transaction_size);
+   _id = SignedTransaction::id_from_digest(_digest);
+   _payloads.reserve(_trx.messages.size());
+   for (size_t i = 0; i < _trx.messages.size(); ++i)
+      _payloads.emplace_back(std::make_shared<message_payload_cache>());
+}
+
+digest_type transaction_metadata::sig_digest(const chain_id_type& chain_id)const {
+   digest_type::encoder enc;
+   fc::raw::pack(enc, chain_id);
+   enc.write(_packed.data(), _transaction_size);
+   return enc.result();
+}
+
 digest_type generated_transaction::merkle_digest() const {
    digest_type::encoder enc;
    fc::raw::pack(enc, *this);
    return enc.result();
 }
 
+flat_set<AccountName> generated_transaction::read_scope()const {
+   return messages_read_scope(messages);
+}
+
+flat_set<AccountName> generated_transaction::write_scope()const {
+   return messages_write_scope(messages);
+}
+
 } } // eos::chain
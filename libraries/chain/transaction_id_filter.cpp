@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/transaction_id_filter.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+
+namespace eos { namespace chain {
+
+transaction_id_filter::transaction_id_filter(uint32_t window_seconds, uint64_t expected_per_window,
+                                             double false_positive_rate)
+   : _window_seconds(window_seconds) {
+   FC_ASSERT(window_seconds > 0, "Transaction filter windows must not be empty");
+   _parameters.projected_element_count = expected_per_window;
+   _parameters.false_positive_probability = false_positive_rate;
+   FC_ASSERT(!!_parameters, "Invalid transaction filter parameters",
+             ("expected_per_window", expected_per_window)("false_positive_rate", false_positive_rate));
+   _parameters.compute_optimal_parameters();
+}
+
+void transaction_id_filter::insert(const transaction_id_type& id, time_point_sec expiration) {
+   uint32_t start = expiration.sec_since_epoch() - expiration.sec_since_epoch() % _window_seconds;
+   auto itr = std::lower_bound(_windows.begin(), _windows.end(), start,
+                               [](const window& w, uint32_t s) { return w.start < s; });
+   if (itr == _windows.end() || itr->start != start)
+      itr = _windows.insert(itr, window{start, fc::bloom_filter(_parameters)});
+   itr->filter.insert(id.data(), id.data_size());
+}
+
+bool transaction_id_filter::may_contain(const transaction_id_type& id)const {
+   for (const auto& w : _windows)
+      if (w.filter.contains(id.data(), id.data_size()))
+         return true;
+   return false;
+}
+
+void transaction_id_filter::expire(time_point_sec time) {
+   while (!_windows.empty() && _windows.front().start + _window_seconds <= time.sec_since_epoch())
+      _windows.pop_front();
+}
+
+time_point_sec transaction_id_filter::earliest_window_end()const {
+   if (_windows.empty())
+      return time_point_sec::maximum();
+   return time_point_sec(_windows.front().start + _window_seconds);
+}
+
+} } // eos::chain
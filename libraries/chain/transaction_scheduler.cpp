@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/transaction_scheduler.hpp>
+
+#include <algorithm>
+
+namespace eos { namespace chain {
+
+template<typename A, typename B>
+static bool intersects(const A& a, const B& b) {
+   auto ai = a.begin(), bi = b.begin();
+   while (ai != a.end() && bi != b.end()) {
+      if (*ai < *bi) ++ai;
+      else if (*bi < *ai) ++bi;
+      else return true;
+   }
+   return false;
+}
+
+transaction_scheduler::transaction_scheduler(vector<cycle>& cycles, size_t max_threads_per_cycle)
+   : _cycles(cycles), _max_threads(std::max<size_t>(max_threads_per_cycle, 1)) {
+   FC_ASSERT(_cycles.empty(), "Transactions may only be scheduled into an empty block");
+}
+
+void transaction_scheduler::start_cycle() {
+   _cycles.emplace_back();
+   _scopes.clear();
+}
+
+void transaction_scheduler::schedule(const SignedTransaction& trx) {
+   auto reads = trx.read_scope();
+   auto writes = trx.write_scope();
+
+   if (_cycles.empty())
+      start_cycle();
+
+   optional<size_t> target;
+   bool multiple_conflicts = false;
+   for (size_t i = 0; i < _scopes.size(); ++i) {
+      const auto& s = _scopes[i];
+      if (intersects(writes, s.writes) || intersects(writes, s.reads) || intersects(reads, s.writes)) {
+         if (target) {
+            multiple_conflicts = true;
+            break;
+         }
+         target = i;
+      }
+   }
+
+   if (multiple_conflicts) {
+      start_cycle();
+      target.reset();
+   }
+
+   auto& current = _cycles.back();
+   if (!target) {
+      if (current.size() < _max_threads) {
+         current.emplace_back();
+         _scopes.emplace_back();
+         target = current.size() - 1;
+      } else {
+         auto shortest = std::min_element(current.begin(), current.end(), [](const thread& a, const thread& b) {
+            return a.user_input.size() < b.user_input.size();
+         });
+         target = shortest - current.begin();
+      }
+   }
+
+   current[*target].user_input.emplace_back(trx);
+   _scopes[*target].reads.insert(reads.begin(), reads.end());
+   _scopes[*target].writes.insert(writes.begin(), writes.end());
+}
+
+block_schedule_stats transaction_scheduler::stats()const {
+   block_schedule_stats result;
+   result.cycles = _cycles.size();
+   for (const auto& c : _cycles) {
+      size_t longest = 0;
+      for (const auto& t : c) {
+         result.transactions += t.user_input.size();
+         longest = std::max(longest, t.user_input.size());
+      }
+      result.threads += c.size();
+      result.max_threads_per_cycle = std::max<uint32_t>(result.max_threads_per_cycle, c.size());
+      result.critical_path += longest;
+   }
+   return result;
+}
+
+} } // eos::chain
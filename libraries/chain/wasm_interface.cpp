@@ -7,16 +7,220 @@
 #include "IR/Module.h"
 #include "IR/Operators.h"
 #include "IR/Validate.h"
+#include <eos/chain/config.hpp>
 #include <eos/chain/key_value_object.hpp>
 #include <eos/chain/account_object.hpp>
+#include <eos/chain/thread_pool.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/crypto/city.hpp>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace eos { namespace chain {
    using namespace IR;
    using namespace Runtime;
 
+   /**
+    * Keeps the machine code generated for contracts in a directory, one file per cache key, so that it survives restarts.
+    * Failing to read or write the cache only costs a recompilation.
+    */
+   class file_object_cache : public Runtime::ObjectCache {
+      public:
+         file_object_cache( const fc::path& dir ):_dir(dir) {
+            fc::create_directories( _dir );
+         }
+
+         bool load( const std::string& key, std::vector<U8>& object_code ) override {
+            std::ifstream in( path_of(key).string(), std::ios::binary );
+            if( !in ) return false;
+            object_code.assign( std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() );
+            return !in.bad() && object_code.size();
+         }
+
+         void store( const std::string& key, const std::vector<U8>& object_code ) override {
+            try {
+               // Write a temporary file and rename it into place, so a crash never leaves a truncated object behind
+               auto path = path_of(key);
+               auto tmp_path = path.string() + ".tmp";
+               {
+                  std::ofstream out( tmp_path, std::ios::binary | std::ios::trunc );
+                  out.write( (const char*)object_code.data(), object_code.size() );
+                  FC_ASSERT( out.good(), "failed to write ${p}", ("p",tmp_path) );
+               }
+               fc::rename( tmp_path, path );
+            } catch( const fc::exception& e ) {
+               wlog( "unable to cache compiled contract: ${e}", ("e",e.to_detail_string()) );
+            }
+         }
+
+      private:
+         fc::path path_of( const std::string& key )const {
+            return _dir / (fc::sha256::hash( key ).str() + ".o");
+         }
+
+         fc::path _dir;
+   };
+
+   /**
+    * Keeps the machine code generated for the most recently used contracts in memory, so that each thread instantiating
+    * a contract only has to link it, in front of an optional cache which persists it. May be used from several threads
+    * at once.
+    */
+   class memory_object_cache : public Runtime::ObjectCache {
+      public:
+         explicit memory_object_cache( size_t capacity ) : _capacity( std::max<size_t>( capacity, 1 ) ) {}
+
+         void set_backing_cache( std::unique_ptr<Runtime::ObjectCache> cache ) {
+            std::lock_guard<std::mutex> lock( _mutex );
+            _backing = std::move( cache );
+         }
+
+         bool load( const std::string& key, std::vector<U8>& object_code ) override {
+            std::lock_guard<std::mutex> lock( _mutex );
+            auto itr = _index.find( key );
+            if( itr != _index.end() ) {
+               _lru.splice( _lru.begin(), _lru, itr->second );
+               object_code = itr->second->second;
+               return true;
+            }
+            if( !_backing || !_backing->load( key, object_code ) ) return false;
+            insert( key, object_code );
+            return true;
+         }
+
+         void store( const std::string& key, const std::vector<U8>& object_code ) override {
+            std::lock_guard<std::mutex> lock( _mutex );
+            auto itr = _index.find( key );
+            if( itr != _index.end() ) {
+               _lru.erase( itr->second );
+               _index.erase( itr );
+            }
+            insert( key, object_code );
+            if( _backing ) _backing->store( key, object_code );
+         }
+
+      private:
+         using lru_list = std::list<std::pair<std::string, std::vector<U8>>>;
+
+         /// Requires _mutex and that key is not cached; evicts the least recently used code when over capacity
+         void insert( const std::string& key, const std::vector<U8>& object_code ) {
+            _lru.emplace_front( key, object_code );
+            _index.emplace( key, _lru.begin() );
+            if( _index.size() > _capacity ) {
+               _index.erase( _lru.back().first );
+               _lru.pop_back();
+            }
+         }
+
+         const size_t                                        _capacity;
+         std::mutex                                          _mutex;
+         std::unique_ptr<Runtime::ObjectCache>               _backing;
+         lru_list                                            _lru;
+         std::unordered_map<std::string, lru_list::iterator> _index; ///< keyed by the runtime's object cache key
+   };
+
+   /**
+    * The state shared by the wasm_interface of every thread: the code of contracts, which is immutable once deserialized
+    * and compiled, and its compilation ahead of time.
+    */
+   struct shared_code {
+      static shared_code& get() {
+         // Initialized exactly once, even if first used from several threads
+         static shared_code* code = new shared_code();
+         return *code;
+      }
+
+      /// @return the module deserialized from @ref code, which has version @ref code_version
+      std::shared_ptr<const IR::Module> get_module( const fc::sha256& code_version, const char* code, size_t size ) {
+         std::lock_guard<std::mutex> lock( mutex );
+         auto& module = modules[code_version];
+         if( !module ) {
+            auto deserialized = std::make_shared<IR::Module>();
+            Serialization::MemoryInputStream stream( (const U8*)code, size );
+            WASM::serialize( stream, *deserialized );
+            module = std::move( deserialized );
+         }
+         return module;
+      }
+
+      memory_object_cache                                  object_cache{ config::CompiledContractCacheSize };
+
+      std::mutex                                           mutex;
+      map<fc::sha256, std::shared_ptr<const IR::Module>>   modules;      ///< guarded by mutex
+      /// Compiles code ahead of time; LLVM code generation is serialized by the runtime, so one worker suffices
+      std::unique_ptr<thread_pool>                         compile_pool; ///< guarded by mutex
+      /// Compilations which have not finished yet; guarded by mutex
+      map<fc::sha256, std::shared_future<void>>            precompiled;
+
+      private:
+         shared_code() {
+            wlog( "Runtime::init" );
+            Runtime::init();
+         }
+   };
+
    wasm_interface::wasm_interface() {
    }
 
+   wasm_interface::~wasm_interface() {
+      // Runs when the thread exits; the instances themselves are still leaked, as when their code is updated
+      for( auto& instance : instances )
+         if( instance.second.init_memory )
+            Runtime::deleteMemorySnapshot( instance.second.init_memory );
+   }
+
+   void wasm_interface::set_code_cache_dir( const fc::path& dir ) {
+      auto& shared = shared_code::get();
+      try {
+         shared.object_cache.set_backing_cache( std::unique_ptr<Runtime::ObjectCache>( new file_object_cache( dir ) ) );
+         std::lock_guard<std::mutex> lock( shared.mutex );
+         if( !shared.compile_pool )
+            shared.compile_pool.reset( new thread_pool(1) );
+      } catch( const fc::exception& e ) {
+         wlog( "compiled contracts will not be cached: ${e}", ("e",e.to_detail_string()) );
+      }
+   }
+
+   void wasm_interface::precompile( const types::Bytes& code ) {
+      auto& shared = shared_code::get();
+      auto code_version = fc::sha256::hash( code.data(), code.size() );
+
+      std::lock_guard<std::mutex> lock( shared.mutex );
+      if( !shared.compile_pool || shared.precompiled.count( code_version ) ) return;
+      if( shared.precompiled.size() >= size_t(config::MaxPendingPrecompiles) ) return;
+
+      shared.precompiled[code_version] = shared.compile_pool->post( [&shared, code, code_version]() {
+         try {
+            IR::Module module;
+            Serialization::MemoryInputStream stream( (const U8*)code.data(), code.size() );
+            WASM::serialize( stream, module );
+            // Does nothing if the machine code is in the cache already
+            Runtime::compileModule( module, &shared.object_cache, code_version.str() );
+         } catch( ... ) {
+            // Invalid code is reported when a contract using it is loaded
+            wlog( "unable to compile contract code ${v} ahead of time", ("v",code_version) );
+         }
+         // Loading the code now finds the machine code in the cache
+         std::lock_guard<std::mutex> lock( shared.mutex );
+         shared.precompiled.erase( code_version );
+      }).share();
+   }
+
+   void wasm_interface::wait_for_precompile( const fc::sha256& code_version ) {
+      auto& shared = shared_code::get();
+      std::shared_future<void> pending;
+      {
+         std::lock_guard<std::mutex> lock( shared.mutex );
+         auto itr = shared.precompiled.find( code_version );
+         if( itr == shared.precompiled.end() ) return;
+         pending = itr->second;
+      }
+      pending.wait();
+   }
+
 DEFINE_INTRINSIC_FUNCTION4(env,store,store,none,i32,keyptr,i32,keylen,i32,valueptr,i32,valuelen ) {
 //   ilog( "store ${keylen}  ${vallen}", ("keylen",keylen)("vallen",valuelen) );
    FC_ASSERT( keylen > 0 );
@@ -248,14 +452,10 @@ DEFINE_INTRINSIC_FUNCTION1(env,toUpper,toUpper,none,i32,charptr) {
 }
 
    wasm_interface& wasm_interface::get() {
-      static wasm_interface*  wasm = nullptr;
-      if( !wasm )
-      {
-         wlog( "Runtime::init" );
-	       Runtime::init();
-         wasm = new wasm_interface();
-      }
-      return *wasm;
+      // The runtime is initialized once for all threads, which then each instantiate contracts on their own
+      shared_code::get();
+      thread_local wasm_interface wasm;
+      return wasm;
    }
 
 
@@ -290,46 +490,78 @@ DEFINE_INTRINSIC_FUNCTION1(env,toUpper,toUpper,none,i32,charptr) {
       return U32(ptr - &memoryRef<char>(current_memory,0));
    }
 
-   void  wasm_interface::vm_call( std::string name ) {
+   size_t wasm_interface::entry_point_key_hash::operator()( const entry_point_key& k )const {
+      char packed[1 + sizeof(k.type.data) + sizeof(k.recipient.data)];
+      packed[0] = char(k.phase);
+      memcpy( packed + 1, &k.type.data, sizeof(k.type.data) );
+      memcpy( packed + 1 + sizeof(k.type.data), &k.recipient.data, sizeof(k.recipient.data) );
+      return fc::city_hash64( packed, sizeof(packed) );
+   }
+
+   wasm_interface::entry_point_table wasm_interface::find_entry_points( const IR::Module& module, ModuleInstance* instance ) {
+      static const std::pair<std::string, entry_point> prefixes[] = {
+         { "onValidate_",     entry_point::validate     },
+         { "onPrecondition_", entry_point::precondition },
+         { "onApply_",        entry_point::apply        }
+      };
+      // Names longer than a TypeName or AccountName, or with embedded nulls, can't be produced by any message
+      auto is_name = []( const std::string& str ) {
+         return str.size() <= sizeof(TypeName::data) && str.find('\0') == std::string::npos;
+      };
+
+      entry_point_table table;
+      for( const auto& exp : module.exports ) {
+         if( exp.kind != IR::ObjectKind::function ) continue;
+         for( const auto& prefix : prefixes ) {
+            if( exp.name.compare( 0, prefix.first.size(), prefix.first ) ) continue;
+
+            FunctionInstance* function = asFunctionNullable(getInstanceExport(instance,exp.name.c_str()));
+            if( !function ) break;
+
+            // Either of the type and recipient may contain '_' too, so register every way of splitting the rest of
+            // the name; each matches exactly the messages whose <type>_<recipient> spells this export's name
+            const auto suffix = exp.name.substr( prefix.first.size() );
+            for( auto pos = suffix.find('_'); pos != std::string::npos; pos = suffix.find('_', pos + 1) ) {
+               const auto type      = suffix.substr( 0, pos );
+               const auto recipient = suffix.substr( pos + 1 );
+               if( is_name(type) && is_name(recipient) )
+                  table.emplace( entry_point_key{ prefix.second, TypeName(type), AccountName(recipient) }, function );
+            }
+            break;
+         }
+      }
+      return table;
+   }
+
+   void  wasm_interface::vm_call( entry_point phase ) {
    try {
       try {
-         name += std::string( current_validate_context->msg.type ) + "_";
-         name += std::string( current_validate_context->msg.recipient );
-
-				 FunctionInstance* apply = asFunctionNullable(getInstanceExport(current_module,name.c_str()));
-		 		 if( !apply ) return; /// if not found then it is a no-op
+         const auto& msg = current_validate_context->msg;
+         auto itr = current_state->entry_points.find( entry_point_key{ phase, msg.type, msg.recipient } );
+         if( itr == current_state->entry_points.end() ) return; /// if not found then it is a no-op
 
-				 const FunctionType* functionType = getFunctionType(apply);
-				 FC_ASSERT( functionType->parameters.size() == 0 );
-				 std::vector<Value> args(0);
-				 Runtime::invokeFunction(apply,args);
+         Runtime::invokeNullaryFunction( itr->second );
       } catch( const Runtime::Exception& e ) {
           edump((std::string(describeExceptionCause(e.cause))));
 					edump((e.callStack));
 					throw;
       }
-   } FC_CAPTURE_AND_RETHROW( (name)(current_validate_context->msg.type) ) }
+   } FC_CAPTURE_AND_RETHROW( (current_validate_context->msg.type)(current_validate_context->msg.recipient) ) }
 
-   void  wasm_interface::vm_precondition() { vm_call( "onPrecondition_" ); } 
-   void  wasm_interface::vm_apply()        { vm_call( "onApply_" );        }
-   void  wasm_interface::vm_validate()     { vm_call("onValidate_");       }
+   void  wasm_interface::vm_precondition() { vm_call( entry_point::precondition ); }
+   void  wasm_interface::vm_apply()        { vm_call( entry_point::apply );        }
+   void  wasm_interface::vm_validate()     { vm_call( entry_point::validate );     }
 
    void  wasm_interface::vm_onInit()
    { try {
       try {
          // wlog( "onInit" );
-				 FunctionInstance* apply = asFunctionNullable(getInstanceExport(current_module,"onInit"));
-		 		 if( !apply ) {
+		 		 if( !current_state->on_init ) {
            wlog( "no onInit method found" );
 					 return; /// if not found then it is a no-op
          }
 
-				 const FunctionType* functionType = getFunctionType(apply);
-				 FC_ASSERT( functionType->parameters.size() == 0 );
-
-				 std::vector<Value> args(0);
-
-				 Runtime::invokeFunction(apply,args);
+				 Runtime::invokeNullaryFunction( current_state->on_init );
       } catch( const Runtime::Exception& e ) {
           edump((std::string(describeExceptionCause(e.cause))));
 					edump((e.callStack));
@@ -392,26 +624,39 @@ DEFINE_INTRINSIC_FUNCTION1(env,toUpper,toUpper,none,i32,charptr) {
             /// TODO: free existing instance and module
 #warning TODO: free existing module if the code has been updated, currently leak memory
             state.instance     = nullptr;
-            state.module       = nullptr;
+            state.module.reset();
             state.code_version = fc::sha256();
+            state.entry_points.clear();
+            state.on_init      = nullptr;
+            if( state.init_memory ) {
+               Runtime::deleteMemorySnapshot( state.init_memory );
+               state.init_memory = nullptr;
+            }
          }
-         state.module = new IR::Module();
 
         try
         {
           wlog( "LOADING CODE" );
-          Serialization::MemoryInputStream stream((const U8*)recipient.code.data(),recipient.code.size());
-          WASM::serialize(stream,*state.module);
+          auto& shared = shared_code::get();
+          state.module = shared.get_module( recipient.code_version, recipient.code.data(), recipient.code.size() );
+
+          // Rather than compiling the code again, link the machine code of any background compilation of it
+          wait_for_precompile( recipient.code_version );
 
           RootResolver rootResolver;
           LinkResult linkResult = linkModule(*state.module,rootResolver);
-          state.instance = instantiateModule( *state.module, std::move(linkResult.resolvedImports) );
+          // Each thread instantiates the module itself, linking the machine code shared through the object cache
+          state.instance = instantiateModule( *state.module, std::move(linkResult.resolvedImports),
+                                              &shared.object_cache, recipient.code_version.str() );
           FC_ASSERT( state.instance );
+          state.entry_points = find_entry_points( *state.module, state.instance );
+          state.on_init      = asFunctionNullable(getInstanceExport(state.instance,"onInit"));
           current_memory = Runtime::getDefaultMemory(state.instance);
 
+          // Every handler starts from the memory as instantiated; the snapshot covers all of its initial pages
+          state.init_memory = Runtime::createMemorySnapshot( current_memory );
+          FC_ASSERT( state.init_memory, "unable to snapshot contract memory" );
           char* memstart = &memoryRef<char>( current_memory, 0 );
-          state.init_memory.resize(1<<16); /// TODO: actually get memory size
-          memcpy( state.init_memory.data(), memstart, state.init_memory.size() );
           std::cerr <<"INIT MEMORY: \n";
           for( uint32_t i = 0; i < 10000; ++i )
               if( memstart[i] )
@@ -438,10 +683,11 @@ DEFINE_INTRINSIC_FUNCTION1(env,toUpper,toUpper,none,i32,charptr) {
         }
       }
 
+      current_state  = &state;
       current_module = state.instance;
       current_memory = getDefaultMemory( current_module );
-      char* memstart = &memoryRef<char>( current_memory, 0 );
-      memcpy( memstart, state.init_memory.data(), state.init_memory.size() );
+      // Pages are restored copy-on-write, so only those the previous handler wrote are actually reset
+      FC_ASSERT( Runtime::restoreMemorySnapshot( current_memory, state.init_memory ), "unable to reset contract memory" );
    }
 
 
@@ -9,7 +9,7 @@ namespace eos {
 using namespace chain;
 
 void CreateAccount_Notify_Eos::validate_preconditions(precondition_validate_context& context) {
-   auto create = context.msg.as<types::CreateAccount>();
+   const auto& create = context.msg_as<types::CreateAccount>();
    const auto& creatorBalance = context.db.get<BalanceObject, byOwnerName>(create.creator);
    EOS_ASSERT(creatorBalance.balance >= create.deposit.amount, message_validate_exception,
               "Creator '${c}' has insufficient funds to make account creation deposit of ${a}",
@@ -17,7 +17,7 @@ void CreateAccount_Notify_Eos::validate_preconditions(precondition_validate_cont
 }
 
 void ClaimUnlockedEos_Notify_Eos::apply(apply_context& context) {
-   auto claim = context.msg.as<types::ClaimUnlockedEos>();
+   const auto& claim = context.msg_as<types::ClaimUnlockedEos>();
    const auto& claimant = context.db.get<BalanceObject, byOwnerName>(claim.account);
    context.mutable_db.modify(claimant, [&claim](BalanceObject& a) {
       a.balance += claim.amount;
@@ -25,7 +25,7 @@ void ClaimUnlockedEos_Notify_Eos::apply(apply_context& context) {
 }
 
 void CreateAccount_Notify_Eos::apply(apply_context& context) {
-   auto create = context.msg.as<types::CreateAccount>();
+   const auto& create = context.msg_as<types::CreateAccount>();
    context.mutable_db.create<BalanceObject>([&create](BalanceObject& b) {
       b.ownerName = create.name;
       b.balance = create.deposit.amount;
@@ -37,7 +37,7 @@ void CreateAccount_Notify_Eos::apply(apply_context& context) {
 }
 
 void Transfer::validate(message_validate_context& context) {
-   auto transfer = context.msg.as<types::Transfer>();
+   const auto& transfer = context.msg_as<types::Transfer>();
    try {
       EOS_ASSERT(transfer.amount > Asset(0), message_validate_exception, "Must transfer a positive amount");
       EOS_ASSERT(context.msg.has_notify(transfer.to), message_validate_exception, "Must notify recipient of transfer");
@@ -46,7 +46,7 @@ void Transfer::validate(message_validate_context& context) {
 
 void Transfer::validate_preconditions(precondition_validate_context& context) {
    const auto& db = context.db;
-   auto transfer = context.msg.as<types::Transfer>();
+   const auto& transfer = context.msg_as<types::Transfer>();
 
    try {
       db.get<account_object,by_name>(transfer.to); ///< make sure this exists
@@ -58,7 +58,7 @@ void Transfer::validate_preconditions(precondition_validate_context& context) {
 
 void Transfer::apply(apply_context& context) {
    auto& db = context.mutable_db;
-   auto transfer = context.msg.as<types::Transfer>();
+   const auto& transfer = context.msg_as<types::Transfer>();
    const auto& from = db.get<BalanceObject, byOwnerName>(transfer.from);
    const auto& to = db.get<BalanceObject, byOwnerName>(transfer.to);
    db.modify(from, [&](BalanceObject& a) {
@@ -70,7 +70,7 @@ void Transfer::apply(apply_context& context) {
 }
 
 void TransferToLocked::validate(message_validate_context& context) {
-   auto lock = context.msg.as<types::TransferToLocked>();
+   const auto& lock = context.msg_as<types::TransferToLocked>();
    EOS_ASSERT(lock.amount > 0, message_validate_exception, "Locked amount must be positive");
    EOS_ASSERT(lock.to == lock.from || context.msg.has_notify(lock.to),
               message_validate_exception, "Recipient account must be notified");
@@ -79,7 +79,7 @@ void TransferToLocked::validate(message_validate_context& context) {
 }
 
 void TransferToLocked::validate_preconditions(precondition_validate_context& context) {
-   auto lock = context.msg.as<types::TransferToLocked>();
+   const auto& lock = context.msg_as<types::TransferToLocked>();
    ShareType balance;
    try {
       const auto& sender = context.db.get<BalanceObject, byOwnerName>(lock.from);
@@ -91,7 +91,7 @@ void TransferToLocked::validate_preconditions(precondition_validate_context& con
 }
 
 void TransferToLocked::apply(apply_context& context) {
-   auto lock = context.msg.as<types::TransferToLocked>();
+   const auto& lock = context.msg_as<types::TransferToLocked>();
    const auto& locker = context.db.get<BalanceObject, byOwnerName>(lock.from);
    context.mutable_db.modify(locker, [&lock](BalanceObject& a) {
       a.balance -= lock.amount;
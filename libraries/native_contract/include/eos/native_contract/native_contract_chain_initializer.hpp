@@ -15,6 +15,7 @@ public:
    virtual types::Time get_chain_start_time() override;
    virtual chain::BlockchainConfiguration get_chain_start_configuration() override;
    virtual std::array<types::AccountName, config::BlocksPerRound> get_chain_start_producers() override;
+   virtual chain::chain_id_type get_chain_id() override;
 
    virtual void register_types(chain::chain_controller& chain, chainbase::database& db) override;
    virtual std::vector<chain::Message> prepare_database(chain::chain_controller& chain,
@@ -27,6 +27,10 @@ std::array<types::AccountName, config::BlocksPerRound> native_contract_chain_ini
    return result;
 }
 
+chain::chain_id_type native_contract_chain_initializer::get_chain_id() {
+   return genesis.compute_chain_id();
+}
+
 void native_contract_chain_initializer::register_types(chain_controller& chain, chainbase::database& db) {
    // Install the native contract's indexes; we can't do anything until our objects are recognized
    db.add_index<StakedBalanceMultiIndex>();
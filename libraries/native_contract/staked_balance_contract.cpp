@@ -14,26 +14,26 @@ namespace eos {
 using namespace chain;
 
 void CreateAccount_Notify_Staked::apply(apply_context& context) {
-   auto create = context.msg.as<types::CreateAccount>();
+   const auto& create = context.msg_as<types::CreateAccount>();
    context.mutable_db.create<StakedBalanceObject>([&create](StakedBalanceObject& sbo) {
       sbo.ownerName = create.name;
    });
 }
 
 void TransferToLocked_Notify_Staked::apply(apply_context& context) {
-   auto lock = context.msg.as<types::TransferToLocked>();
+   const auto& lock = context.msg_as<types::TransferToLocked>();
    const auto& balance = context.db.get<StakedBalanceObject, byOwnerName>(lock.to);
 
    balance.stakeTokens(lock.amount, context.mutable_db);
 }
 
 void StartUnlockEos::validate(message_validate_context& context) {
-   auto unlock = context.msg.as<types::StartUnlockEos>();
+   const auto& unlock = context.msg_as<types::StartUnlockEos>();
    EOS_ASSERT(unlock.amount >= 0, message_validate_exception, "Unlock amount cannot be negative");
 }
 
 void StartUnlockEos::validate_preconditions(precondition_validate_context& context) {
-   auto unlock = context.msg.as<types::StartUnlockEos>();
+   const auto& unlock = context.msg_as<types::StartUnlockEos>();
    ShareType balance;
    try {
       balance = context.db.get<StakedBalanceObject, byOwnerName>(unlock.account).stakedBalance;
@@ -43,21 +43,21 @@ void StartUnlockEos::validate_preconditions(precondition_validate_context& conte
 }
 
 void StartUnlockEos::apply(apply_context& context) {
-   auto unlock = context.msg.as<types::StartUnlockEos>();
+   const auto& unlock = context.msg_as<types::StartUnlockEos>();
    const auto& balance = context.db.get<StakedBalanceObject, byOwnerName>(unlock.account);
 
    balance.beginUnstakingTokens(unlock.amount, context.mutable_db);
 }
 
 void ClaimUnlockedEos::validate(message_validate_context& context) {
-   auto claim = context.msg.as<types::ClaimUnlockedEos>();
+   const auto& claim = context.msg_as<types::ClaimUnlockedEos>();
    EOS_ASSERT(claim.amount > 0, message_validate_exception, "Claim amount must be positive");
    EOS_ASSERT(context.msg.has_notify(config::EosContractName), message_validate_exception,
               "EOS Contract (${name}) must be notified", ("name", config::EosContractName));
 }
 
 void ClaimUnlockedEos::validate_preconditions(precondition_validate_context& context) {
-   auto claim = context.msg.as<types::ClaimUnlockedEos>();
+   const auto& claim = context.msg_as<types::ClaimUnlockedEos>();
    auto balance = context.db.find<StakedBalanceObject, byOwnerName>(claim.account);
    EOS_ASSERT(balance != nullptr, message_precondition_exception,
               "Could not find staked balance for ${name}", ("name", claim.account));
@@ -71,7 +71,7 @@ void ClaimUnlockedEos::validate_preconditions(precondition_validate_context& con
 }
 
 void ClaimUnlockedEos::apply(apply_context& context) {
-   auto claim = context.msg.as<types::ClaimUnlockedEos>();
+   const auto& claim = context.msg_as<types::ClaimUnlockedEos>();
    context.mutable_db.modify(context.db.get<StakedBalanceObject, byOwnerName>(claim.account),
                              [&claim](StakedBalanceObject& sbo) {
       sbo.unstakingBalance -= claim.amount;
@@ -79,12 +79,12 @@ void ClaimUnlockedEos::apply(apply_context& context) {
 }
 
 void CreateProducer::validate(message_validate_context& context) {
-   auto create = context.msg.as<types::CreateProducer>();
+   const auto& create = context.msg_as<types::CreateProducer>();
    EOS_ASSERT(create.name.size() > 0, message_validate_exception, "Producer owner name cannot be empty");
 }
 
 void CreateProducer::validate_preconditions(precondition_validate_context& context) {
-   auto create = context.msg.as<types::CreateProducer>();
+   const auto& create = context.msg_as<types::CreateProducer>();
    const auto& db = context.db;
    auto producer = db.find<producer_object, by_owner>(create.name);
    EOS_ASSERT(producer == nullptr, message_precondition_exception,
@@ -92,7 +92,7 @@ void CreateProducer::validate_preconditions(precondition_validate_context& conte
 }
 
 void CreateProducer::apply(apply_context& context) {
-   auto create = context.msg.as<types::CreateProducer>();
+   const auto& create = context.msg_as<types::CreateProducer>();
    auto& db = context.mutable_db;
    db.create<producer_object>([&create](producer_object& p) {
       p.owner = create.name;
@@ -107,13 +107,13 @@ void CreateProducer::apply(apply_context& context) {
 }
 
 void UpdateProducer::validate(message_validate_context& context) {
-   auto update = context.msg.as<types::UpdateProducer>();
+   const auto& update = context.msg_as<types::UpdateProducer>();
    EOS_ASSERT(update.name.size() > 0, message_validate_exception, "Producer owner name cannot be empty");
 }
 
 void UpdateProducer::validate_preconditions(precondition_validate_context& context) {
    const auto& db = context.db;
-   auto update = context.msg.as<types::UpdateProducer>();
+   const auto& update = context.msg_as<types::UpdateProducer>();
    const auto& producer = db.get<producer_object, by_owner>(update.name);
    EOS_ASSERT(producer.signing_key != update.newKey || producer.configuration != update.configuration,
               message_validate_exception, "Producer's new settings may not be identical to old settings");
@@ -121,7 +121,7 @@ void UpdateProducer::validate_preconditions(precondition_validate_context& conte
 
 void UpdateProducer::apply(apply_context& context) {
    auto& db = context.mutable_db;
-   auto update = context.msg.as<types::UpdateProducer>();
+   const auto& update = context.msg_as<types::UpdateProducer>();
    const auto& producer = db.get<producer_object, by_owner>(update.name);
 
    db.modify(producer, [&update](producer_object& p) {
@@ -131,7 +131,7 @@ void UpdateProducer::apply(apply_context& context) {
 }
 
 void ApproveProducer::validate(message_validate_context& context) {
-   auto approve = context.msg.as<types::ApproveProducer>();
+   const auto& approve = context.msg_as<types::ApproveProducer>();
    EOS_ASSERT(approve.approve == 0 || approve.approve == 1, message_validate_exception,
               "Unknown approval value: ${val}; must be either 0 or 1", ("val", approve.approve));
    EOS_ASSERT(approve.producer.size() != 0, message_validate_exception,
@@ -140,7 +140,7 @@ void ApproveProducer::validate(message_validate_context& context) {
 
 void ApproveProducer::validate_preconditions(precondition_validate_context& context) {
    const auto& db = context.db;
-   auto approve = context.msg.as<types::ApproveProducer>();
+   const auto& approve = context.msg_as<types::ApproveProducer>();
    auto producer = db.find<ProducerVotesObject, byOwnerName>(approve.producer);
    auto voter = db.find<StakedBalanceObject, byOwnerName>(context.msg.sender);
 
@@ -168,7 +168,7 @@ void ApproveProducer::validate_preconditions(precondition_validate_context& cont
 
 void ApproveProducer::apply(apply_context& context) {
    auto& db = context.mutable_db;
-   auto approve = context.msg.as<types::ApproveProducer>();
+   const auto& approve = context.msg_as<types::ApproveProducer>();
    const auto& producer = db.get<ProducerVotesObject, byOwnerName>(approve.producer);
    const auto& voter = db.get<StakedBalanceObject, byOwnerName>(context.msg.sender);
    auto raceTime = ProducerScheduleObject::get(db).currentRaceTime;
@@ -196,13 +196,13 @@ void ApproveProducer::apply(apply_context& context) {
 }
 
 void AllowVoteProxying::validate(message_validate_context& context) {
-   auto allow = context.msg.as<types::AllowVoteProxying>();
+   const auto& allow = context.msg_as<types::AllowVoteProxying>();
    EOS_ASSERT(allow.allow == 0 || allow.allow == 1, message_validate_exception,
               "Unknown allow value: ${val}; must be either 0 or 1", ("val", allow.allow));
 }
 
 void AllowVoteProxying::validate_preconditions(precondition_validate_context& context) {
-   auto allow = context.msg.as<types::AllowVoteProxying>();
+   const auto& allow = context.msg_as<types::AllowVoteProxying>();
    auto proxy = context.db.find<ProxyVoteObject, byTargetName>(context.msg.sender);
    if (allow.allow)
       EOS_ASSERT(proxy == nullptr, message_precondition_exception,
@@ -213,7 +213,7 @@ void AllowVoteProxying::validate_preconditions(precondition_validate_context& co
 }
 
 void AllowVoteProxying::apply(apply_context& context) {
-   auto allow = context.msg.as<types::AllowVoteProxying>();
+   const auto& allow = context.msg_as<types::AllowVoteProxying>();
    auto& db = context.mutable_db;
    if (allow.allow)
       db.create<ProxyVoteObject>([target = context.msg.sender](ProxyVoteObject& pvo) {
@@ -227,7 +227,7 @@ void AllowVoteProxying::apply(apply_context& context) {
 }
 
 void SetVoteProxy::validate_preconditions(precondition_validate_context& context) {
-   auto svp = context.msg.as<types::SetVoteProxy>();
+   const auto& svp = context.msg_as<types::SetVoteProxy>();
    const auto& db = context.db;
 
    auto proxy = db.find<ProxyVoteObject, byTargetName>(context.msg.sender);
@@ -249,7 +249,7 @@ void SetVoteProxy::validate_preconditions(precondition_validate_context& context
 }
 
 void SetVoteProxy::apply(apply_context& context) {
-   auto svp = context.msg.as<types::SetVoteProxy>();
+   const auto& svp = context.msg_as<types::SetVoteProxy>();
    auto& db = context.mutable_db;
    const auto& proxy = db.get<ProxyVoteObject, byTargetName>(svp.proxy);
    const auto& balance = db.get<StakedBalanceObject, byOwnerName>(context.msg.sender);
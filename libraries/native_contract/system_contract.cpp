@@ -12,7 +12,7 @@ using namespace chain;
 
 
 void SetCode::validate(message_validate_context& context) {
-   auto  msg = context.msg.as<types::SetCode>();
+   const auto& msg = context.msg_as<types::SetCode>();
    FC_ASSERT( msg.vmtype == 0 );
    FC_ASSERT( msg.vmversion == 0 );
    // TODO: verify code compiles and is properly sanitized
@@ -21,14 +21,14 @@ void SetCode::validate(message_validate_context& context) {
 void SetCode::validate_preconditions(precondition_validate_context& context)
 { try {
    auto& db = context.db;
-   auto  msg = context.msg.as<types::SetCode>();
+   const auto& msg = context.msg_as<types::SetCode>();
    // db.get<type_object,by_scope_name>( boost::make_tuple(msg.account, msg.type))
 
 } FC_CAPTURE_AND_RETHROW() }
 
 void SetCode::apply(apply_context& context) {
    auto& db = context.mutable_db;
-   auto  msg = context.msg.as<types::SetCode>();
+   const auto& msg = context.msg_as<types::SetCode>();
    const auto& account = db.get<account_object,by_name>(msg.account);
    wlog( "set code: ${size}", ("size",msg.code.size()));
    db.modify( account, [&]( auto& a ) {
@@ -43,7 +43,7 @@ void SetCode::apply(apply_context& context) {
 }
 
 void CreateAccount::validate(message_validate_context& context) {
-   auto create = context.msg.as<types::CreateAccount>();
+   const auto& create = context.msg_as<types::CreateAccount>();
 
    EOS_ASSERT(context.msg.has_notify(config::EosContractName), message_validate_exception,
               "Must notify EOS Contract (${name})", ("name", config::EosContractName));
@@ -57,7 +57,7 @@ void CreateAccount::validate(message_validate_context& context) {
 
 void CreateAccount::validate_preconditions(precondition_validate_context& context) {
    const auto& db = context.db;
-   auto create = context.msg.as<types::CreateAccount>();
+   const auto& create = context.msg_as<types::CreateAccount>();
 
    db.get<account_object,by_name>(create.creator); ///< make sure it exists
 
@@ -79,7 +79,7 @@ void CreateAccount::validate_preconditions(precondition_validate_context& contex
 
 void CreateAccount::apply(apply_context& context) {
    auto& db = context.mutable_db;
-   auto create = context.msg.as<types::CreateAccount>();
+   const auto& create = context.msg_as<types::CreateAccount>();
    const auto& new_account = db.create<account_object>([&create, &db](account_object& a) {
       a.name = create.name;
       a.creation_date = db.get(dynamic_global_property_object::id_type()).time;
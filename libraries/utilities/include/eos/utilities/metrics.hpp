@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace eos { namespace utilities {
+
+namespace detail {
+   /// Number of slots a metric spreads its updates over; each thread updates one of them, chosen when it first does
+   constexpr size_t metric_shards = 8;
+   size_t current_shard();
+}
+
+/**
+ * @brief A monotonic count which any number of threads may add to without contending
+ *
+ * Each thread adds to a slot of its own, and reading sums the slots.
+ */
+class counter {
+   public:
+      void add(uint64_t n = 1) { _shards[detail::current_shard()].value.fetch_add(n, std::memory_order_relaxed); }
+      uint64_t value()const;
+
+   private:
+      /// Padded to a cache line so that threads updating neighbouring slots do not contend
+      struct shard {
+         std::atomic<uint64_t> value{0};
+         char                  padding[64 - sizeof(std::atomic<uint64_t>)];
+      };
+      std::array<shard, detail::metric_shards> _shards;
+};
+
+/**
+ * @brief A distribution of values, such as latencies in microseconds, with bounded relative error
+ *
+ * Values are counted in buckets laid out as in HdrHistogram: each power of two is split into sub_buckets equal buckets,
+ * so a value is known to within 1/sub_buckets of itself. Values up to 2^max_exponent are tracked; larger ones are
+ * counted in the last bucket. As with @ref counter, each thread records into a slot of its own.
+ */
+class histogram {
+   public:
+      static constexpr uint32_t sub_bucket_bits = 3;
+      static constexpr uint32_t sub_buckets = 1 << sub_bucket_bits;
+      static constexpr uint32_t max_exponent = 36;
+      static constexpr uint32_t bucket_count = (max_exponent - sub_bucket_bits + 1) * sub_buckets;
+
+      /// A merged copy of the histogram's slots
+      struct snapshot {
+         std::array<uint64_t, bucket_count> buckets{};
+         uint64_t count = 0;
+         uint64_t sum = 0;
+
+         /// @return the upper bound of the bucket holding the value at quantile q, in [0, 1]
+         uint64_t quantile(double q)const;
+      };
+
+      void record(uint64_t value);
+      snapshot read()const;
+
+      static uint32_t bucket_of(uint64_t value);
+      /// @return the largest value counted in bucket
+      static uint64_t bucket_upper_bound(uint32_t bucket);
+
+   private:
+      struct shard {
+         std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+         std::atomic<uint64_t> sum{0};
+         char                  padding[64];
+      };
+      std::array<shard, detail::metric_shards> _shards;
+};
+
+/// Records the microseconds between its construction and destruction into a histogram
+class scoped_timer {
+   public:
+      explicit scoped_timer(histogram& h) : _histogram(h), _start(std::chrono::steady_clock::now()) {}
+      ~scoped_timer() {
+         auto elapsed = std::chrono::steady_clock::now() - _start;
+         _histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+      }
+
+   private:
+      histogram&                            _histogram;
+      std::chrono::steady_clock::time_point _start;
+};
+
+/**
+ * @brief The process's named metrics
+ *
+ * Metrics are created on first use and live as long as the process, so callers may keep references to them. Looking a
+ * metric up takes a lock; updating one does not.
+ */
+class metrics_registry {
+   public:
+      static metrics_registry& get();
+
+      counter&   get_counter(const std::string& name, const std::string& help);
+      histogram& get_histogram(const std::string& name, const std::string& help);
+
+      /**
+       * Render every metric in the Prometheus text exposition format. Counters are exposed as counters; histograms,
+       * whose buckets are too many to expose individually, are exposed as summaries of their quantiles.
+       */
+      std::string prometheus_text()const;
+
+   private:
+      template<typename Metric>
+      struct entry {
+         std::string             help;
+         std::unique_ptr<Metric> metric;
+      };
+
+      mutable std::mutex                       _mutex;
+      std::map<std::string, entry<counter>>    _counters;
+      std::map<std::string, entry<histogram>>  _histograms;
+};
+
+} } // eos::utilities
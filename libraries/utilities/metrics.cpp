@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <eos/utilities/metrics.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace eos { namespace utilities {
+
+size_t detail::current_shard() {
+   static std::atomic<size_t> next_shard{0};
+   thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % metric_shards;
+   return shard;
+}
+
+uint64_t counter::value()const {
+   uint64_t result = 0;
+   for (const auto& s : _shards)
+      result += s.value.load(std::memory_order_relaxed);
+   return result;
+}
+
+uint32_t histogram::bucket_of(uint64_t value) {
+   if (value < sub_buckets)
+      return value;
+   // Position of the highest set bit, which is at least sub_bucket_bits
+   uint32_t exponent = 63 - __builtin_clzll(value);
+   if (exponent >= max_exponent)
+      return bucket_count - 1;
+   uint32_t shift = exponent - sub_bucket_bits;
+   uint32_t sub_bucket = (value >> shift) & (sub_buckets - 1);
+   return (shift + 1) * sub_buckets + sub_bucket;
+}
+
+uint64_t histogram::bucket_upper_bound(uint32_t bucket) {
+   if (bucket < sub_buckets)
+      return bucket;
+   uint32_t shift = bucket / sub_buckets - 1;
+   uint64_t sub_bucket = bucket % sub_buckets;
+   return ((sub_buckets + sub_bucket + 1) << shift) - 1;
+}
+
+void histogram::record(uint64_t value) {
+   auto& s = _shards[detail::current_shard()];
+   s.buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+   s.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+histogram::snapshot histogram::read()const {
+   snapshot result;
+   for (const auto& s : _shards) {
+      for (uint32_t i = 0; i < bucket_count; ++i) {
+         auto n = s.buckets[i].load(std::memory_order_relaxed);
+         result.buckets[i] += n;
+         result.count += n;
+      }
+      result.sum += s.sum.load(std::memory_order_relaxed);
+   }
+   return result;
+}
+
+uint64_t histogram::snapshot::quantile(double q)const {
+   if (count == 0)
+      return 0;
+   // Rank of the value at quantile q, counting from 1
+   uint64_t rank = std::max<uint64_t>(1, uint64_t(q * count + 0.5));
+   uint64_t seen = 0;
+   for (uint32_t i = 0; i < bucket_count; ++i) {
+      seen += buckets[i];
+      if (seen >= rank)
+         return bucket_upper_bound(i);
+   }
+   return bucket_upper_bound(bucket_count - 1);
+}
+
+metrics_registry& metrics_registry::get() {
+   static metrics_registry registry;
+   return registry;
+}
+
+counter& metrics_registry::get_counter(const std::string& name, const std::string& help) {
+   std::lock_guard<std::mutex> lock(_mutex);
+   auto& e = _counters[name];
+   if (!e.metric) {
+      e.help = help;
+      e.metric.reset(new counter);
+   }
+   return *e.metric;
+}
+
+histogram& metrics_registry::get_histogram(const std::string& name, const std::string& help) {
+   std::lock_guard<std::mutex> lock(_mutex);
+   auto& e = _histograms[name];
+   if (!e.metric) {
+      e.help = help;
+      e.metric.reset(new histogram);
+   }
+   return *e.metric;
+}
+
+std::string metrics_registry::prometheus_text()const {
+   static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+   std::lock_guard<std::mutex> lock(_mutex);
+   std::ostringstream out;
+   for (const auto& c : _counters) {
+      out << "# HELP " << c.first << ' ' << c.second.help << '\n'
+          << "# TYPE " << c.first << " counter\n"
+          << c.first << ' ' << c.second.metric->value() << '\n';
+   }
+   for (const auto& h : _histograms) {
+      auto values = h.second.metric->read();
+      out << "# HELP " << h.first << ' ' << h.second.help << '\n'
+          << "# TYPE " << h.first << " summary\n";
+      for (auto q : quantiles)
+         out << h.first << "{quantile=\"" << q << "\"} " << values.quantile(q) << '\n';
+      out << h.first << "_sum " << values.sum << '\n'
+          << h.first << "_count " << values.count << '\n';
+   }
+   return out.str();
+}
+
+} } // eos::utilities
@@ -88,6 +88,23 @@ namespace Platform
 	// baseVirtualAddress must be a multiple of the preferred page size.
 	PLATFORM_API void freeVirtualPages(U8* baseVirtualAddress,Uptr numPages);
 
+	// A saved copy of the contents of some committed pages.
+	struct PageSnapshot;
+
+	// Saves the contents of the specified committed pages.
+	// baseVirtualAddress must be a multiple of the preferred page size.
+	// Returns nullptr if the snapshot could not be created.
+	PLATFORM_API PageSnapshot* createPageSnapshot(const U8* baseVirtualAddress,Uptr numPages);
+
+	// Restores the contents of the pages a snapshot was created from, and makes them read-write.
+	// Where possible, the snapshot is mapped copy-on-write over the pages, so restoring only discards the pages written
+	// since the last restore, and pages are only copied when they are written.
+	// Returns false if the pages could not be restored.
+	PLATFORM_API bool restorePageSnapshot(PageSnapshot* snapshot,U8* baseVirtualAddress);
+
+	// Frees a snapshot. Pages it has been restored to keep their contents.
+	PLATFORM_API void destroyPageSnapshot(PageSnapshot* snapshot);
+
 	//
 	// Call stack and exceptions
 	//
@@ -124,6 +124,11 @@ namespace Runtime
 	// Throws a Runtime::Exception if a trap occurs.
 	Result invokeFunction(FunctionInstance* function,const std::vector<Value>& parameters);
 
+	// Invokes a FunctionInstance that takes no parameters, discarding its result. Unlike invokeFunction, this doesn't
+	// allocate once the function has been invoked before, so it suits entry points that are called over and over.
+	// Throws a Runtime::Exception if a trap occurs, or if the function takes parameters.
+	RUNTIME_API void invokeNullaryFunction(FunctionInstance* function);
+
 	void invokeFunction2(FunctionInstance* function,const std::vector<Value>& parameters);
 
   void test( int a );
@@ -171,6 +176,19 @@ namespace Runtime
 	RUNTIME_API Iptr growMemory(MemoryInstance* memory,Uptr numPages);
 	RUNTIME_API Iptr shrinkMemory(MemoryInstance* memory,Uptr numPages);
 
+	// A saved copy of the contents and size of a memory.
+	struct MemorySnapshot;
+
+	// Saves the current contents and size of a memory. May return null if the snapshot could not be created.
+	RUNTIME_API MemorySnapshot* createMemorySnapshot(MemoryInstance* memory);
+
+	// Resizes a memory to the size it had when a snapshot was taken of it, and restores the contents it had then.
+	// Where the platform allows, only the pages written since the last restore are copied. Returns false on failure.
+	RUNTIME_API bool restoreMemorySnapshot(MemoryInstance* memory,MemorySnapshot* snapshot);
+
+	// Frees a memory snapshot.
+	RUNTIME_API void deleteMemorySnapshot(MemorySnapshot* snapshot);
+
 	// Validates that an offset range is wholly inside a Memory's virtual address range.
 	RUNTIME_API U8* getValidatedMemoryOffsetRange(MemoryInstance* memory,Uptr offset,Uptr numBytes);
 	
@@ -207,9 +225,31 @@ namespace Runtime
 		std::vector<GlobalInstance*> globals;
 	};
 
+	// A store for the machine code generated for modules, so it can be reused instead of generated again.
+	// The runtime adds its own version and target information to the keys it is given.
+	struct ObjectCache
+	{
+		virtual ~ObjectCache() {}
+
+		// Loads the object code stored under a key. Returns false if there is none.
+		virtual bool load(const std::string& key,std::vector<U8>& outObjectCode) = 0;
+
+		// Stores the object code generated for a key.
+		virtual void store(const std::string& key,const std::vector<U8>& objectCode) = 0;
+	};
+
 	// Instantiates a module, bindings its imports to the specified objects. May throw InstantiationException.
 	RUNTIME_API ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports);
 
+	// Instantiates a module like the above, but uses the machine code stored in objectCache under cacheKey if there is any,
+	// and otherwise stores the machine code it generates there. The key must identify the module's contents.
+	RUNTIME_API ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports,ObjectCache* objectCache,const std::string& cacheKey);
+
+	// Generates the machine code for a module without instantiating it, and stores it in objectCache under cacheKey,
+	// so a later instantiateModule with the same key only has to link it. Does nothing if it is already stored.
+	// May be called on any thread; code generation is serialized with the module instantiations that need it.
+	RUNTIME_API void compileModule(const IR::Module& module,ObjectCache* objectCache,const std::string& cacheKey);
+
 	// Gets the default table/memory for a ModuleInstance.
 	RUNTIME_API MemoryInstance* getDefaultMemory(ModuleInstance* moduleInstance);
 	RUNTIME_API TableInstance* getDefaultTable(ModuleInstance* moduleInstance);
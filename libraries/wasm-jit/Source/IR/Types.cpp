@@ -1,6 +1,7 @@
 #include "Types.h"
 
 #include <map>
+#include <mutex>
 
 namespace IR
 {
@@ -22,9 +23,17 @@ namespace IR
 		}
 	};
 
+	// Guards the maps of interned types, since modules may be loaded on several threads.
+	static std::mutex& getTypeMapMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
 	template<typename Key,typename Value,typename CreateValueThunk>
 	Value findExistingOrCreateNew(std::map<Key,Value>& map,Key&& key,CreateValueThunk createValueThunk)
 	{
+		std::lock_guard<std::mutex> lock(getTypeMapMutex());
 		auto mapIt = map.find(key);
 		if(mapIt != map.end()) { return mapIt->second; }
 		else
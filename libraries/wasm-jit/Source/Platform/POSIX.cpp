@@ -16,6 +16,8 @@
 
 #include <sys/time.h>
 
+#include <vector>
+
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
@@ -26,6 +28,7 @@
 #ifdef __linux__
 	#include <execinfo.h>
 	#include <dlfcn.h>
+	#include <sys/syscall.h>
 #endif
 
 namespace Platform
@@ -99,6 +102,92 @@ namespace Platform
 		if(munmap(baseVirtualAddress,numPages << getPageSizeLog2())) { Errors::fatal("munmap failed"); }
 	}
 
+	struct PageSnapshot
+	{
+		Uptr numBytes;
+
+		// An anonymous file holding the snapshot, or -1 if the snapshot is held in copy.
+		int fd;
+		std::vector<U8> copy;
+
+		// The address the file is currently mapped copy-on-write at, if any.
+		U8* mappedAddress;
+	};
+
+	// Creates an anonymous file that is only reachable through the returned descriptor, or returns -1.
+	static int createAnonymousFile()
+	{
+		#if defined(__linux__) && defined(SYS_memfd_create)
+			return (int)syscall(SYS_memfd_create,"wavm-page-snapshot",0);
+		#else
+			return -1;
+		#endif
+	}
+
+	PageSnapshot* createPageSnapshot(const U8* baseVirtualAddress,Uptr numPages)
+	{
+		errorUnless(isPageAligned(const_cast<U8*>(baseVirtualAddress)));
+		auto snapshot = new PageSnapshot;
+		snapshot->numBytes = numPages << getPageSizeLog2();
+		snapshot->mappedAddress = nullptr;
+
+		// Write the pages to an anonymous file, so they can be mapped copy-on-write.
+		snapshot->fd = createAnonymousFile();
+		if(snapshot->fd != -1)
+		{
+			Uptr numWrittenBytes = 0;
+			if(!ftruncate(snapshot->fd,snapshot->numBytes))
+			{
+				while(numWrittenBytes < snapshot->numBytes)
+				{
+					auto result = pwrite(snapshot->fd,baseVirtualAddress + numWrittenBytes,snapshot->numBytes - numWrittenBytes,numWrittenBytes);
+					if(result <= 0 && errno != EINTR) { break; }
+					if(result > 0) { numWrittenBytes += result; }
+				}
+			}
+			if(numWrittenBytes == snapshot->numBytes) { return snapshot; }
+			close(snapshot->fd);
+			snapshot->fd = -1;
+		}
+
+		// Otherwise, fall back to keeping a copy of the pages.
+		snapshot->copy.assign(baseVirtualAddress,baseVirtualAddress + snapshot->numBytes);
+		return snapshot;
+	}
+
+	bool restorePageSnapshot(PageSnapshot* snapshot,U8* baseVirtualAddress)
+	{
+		errorUnless(isPageAligned(baseVirtualAddress));
+		if(!snapshot->numBytes) { return true; }
+		if(snapshot->fd == -1)
+		{
+			if(mprotect(baseVirtualAddress,snapshot->numBytes,PROT_READ | PROT_WRITE)) { return false; }
+			memcpy(baseVirtualAddress,snapshot->copy.data(),snapshot->numBytes);
+			return true;
+		}
+
+		#ifdef __linux__
+			// Discarding the pages of a private file mapping reverts them to the file's contents, and leaves untouched pages alone.
+			if(snapshot->mappedAddress == baseVirtualAddress)
+			{
+				return !madvise(baseVirtualAddress,snapshot->numBytes,MADV_DONTNEED);
+			}
+		#endif
+
+		// Map the file copy-on-write over the pages, replacing their current contents.
+		auto result = mmap(baseVirtualAddress,snapshot->numBytes,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_FIXED,snapshot->fd,0);
+		if(result != baseVirtualAddress) { snapshot->mappedAddress = nullptr; return false; }
+		snapshot->mappedAddress = baseVirtualAddress;
+		return true;
+	}
+
+	void destroyPageSnapshot(PageSnapshot* snapshot)
+	{
+		// Any mapping of the file keeps it alive until the mapping is removed.
+		if(snapshot->fd != -1) { close(snapshot->fd); }
+		delete snapshot;
+	}
+
 	bool describeInstructionPointer(Uptr ip,std::string& outDescription)
 	{
 		#ifdef __linux__
@@ -6,6 +6,7 @@
 
 #include <inttypes.h>
 #include <algorithm>
+#include <vector>
 #include <Windows.h>
 #include <DbgHelp.h>
 
@@ -85,6 +86,34 @@ namespace Platform
 		if(baseVirtualAddress && !result) { Errors::fatal("VirtualFree(MEM_RELEASE) failed"); }
 	}
 
+	// Snapshots are held in copy: the reserved address-space can't be partially replaced by a file mapping on Windows.
+	struct PageSnapshot
+	{
+		std::vector<U8> copy;
+	};
+
+	PageSnapshot* createPageSnapshot(const U8* baseVirtualAddress,Uptr numPages)
+	{
+		errorUnless(isPageAligned(const_cast<U8*>(baseVirtualAddress)));
+		auto snapshot = new PageSnapshot;
+		snapshot->copy.assign(baseVirtualAddress,baseVirtualAddress + (numPages << getPageSizeLog2()));
+		return snapshot;
+	}
+
+	bool restorePageSnapshot(PageSnapshot* snapshot,U8* baseVirtualAddress)
+	{
+		errorUnless(isPageAligned(baseVirtualAddress));
+		const Uptr numPages = snapshot->copy.size() >> getPageSizeLog2();
+		if(numPages && !commitVirtualPages(baseVirtualAddress,numPages)) { return false; }
+		memcpy(baseVirtualAddress,snapshot->copy.data(),snapshot->copy.size());
+		return true;
+	}
+
+	void destroyPageSnapshot(PageSnapshot* snapshot)
+	{
+		delete snapshot;
+	}
+
 	// The interface to the DbgHelp DLL
 	struct DbgHelp
 	{
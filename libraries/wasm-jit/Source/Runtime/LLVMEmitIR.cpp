@@ -16,16 +16,18 @@ namespace LLVMJIT
 	struct EmitModuleContext
 	{
 		const Module& module;
-		ModuleInstance* moduleInstance;
 
 		llvm::Module* llvmModule;
 		std::vector<llvm::Function*> functionDefs;
+		std::vector<std::string> functionDefDebugNames;
 		std::vector<llvm::Constant*> importedFunctionPointers;
 		std::vector<llvm::Constant*> globalPointers;
 		llvm::Constant* defaultTablePointer;
 		llvm::Constant* defaultTableEndOffset;
 		llvm::Constant* defaultMemoryBase;
 		llvm::Constant* defaultMemoryAddressMask;
+		llvm::Constant* defaultMemoryObjectAsI64;
+		llvm::Constant* defaultTableObjectAsI64;
 		
 		llvm::DIBuilder diBuilder;
 		llvm::DICompileUnit* diCompileUnit;
@@ -36,9 +38,8 @@ namespace LLVMJIT
 		llvm::MDNode* likelyFalseBranchWeights;
 		llvm::MDNode* likelyTrueBranchWeights;
 
-		EmitModuleContext(const Module& inModule,ModuleInstance* inModuleInstance)
+		EmitModuleContext(const Module& inModule)
 		: module(inModule)
-		, moduleInstance(inModuleInstance)
 		, llvmModule(new llvm::Module("",context))
 		, diBuilder(*llvmModule)
 		{
@@ -61,6 +62,17 @@ namespace LLVMJIT
 		}
 
 		llvm::Module* emit();
+
+		// Declares an external variable or function symbol (see LLVMJIT::Symbols), which is resolved when the module is linked.
+		llvm::GlobalVariable* getSymbol(const std::string& name,llvm::Type* type)
+		{
+			if(auto global = llvmModule->getNamedGlobal(name)) { return global; }
+			return new llvm::GlobalVariable(*llvmModule,type,false,llvm::GlobalValue::ExternalLinkage,nullptr,name);
+		}
+		llvm::Constant* getFunctionSymbol(const std::string& name,llvm::FunctionType* type)
+		{
+			return llvmModule->getOrInsertFunction(name,type);
+		}
 	};
 
 	// The context used by functions involved in JITing a single AST function.
@@ -72,7 +84,7 @@ namespace LLVMJIT
 		const Module& module;
 		const FunctionDef& functionDef;
 		const FunctionType* functionType;
-		FunctionInstance* functionInstance;
+		Uptr functionDefIndex;
 		llvm::Function* llvmFunction;
 		llvm::IRBuilder<> irBuilder;
 
@@ -114,12 +126,12 @@ namespace LLVMJIT
 		std::vector<BranchTarget> branchTargetStack;
 		std::vector<llvm::Value*> stack;
 
-		EmitFunctionContext(EmitModuleContext& inEmitModuleContext,const Module& inModule,const FunctionDef& inFunctionDef,FunctionInstance* inFunctionInstance,llvm::Function* inLLVMFunction)
+		EmitFunctionContext(EmitModuleContext& inEmitModuleContext,const Module& inModule,Uptr inFunctionDefIndex,llvm::Function* inLLVMFunction)
 		: moduleContext(inEmitModuleContext)
 		, module(inModule)
-		, functionDef(inFunctionDef)
-		, functionType(inModule.types[inFunctionDef.type.index])
-		, functionInstance(inFunctionInstance)
+		, functionDef(inModule.functions.defs[inFunctionDefIndex])
+		, functionType(inModule.types[functionDef.type.index])
+		, functionDefIndex(inFunctionDefIndex)
 		, llvmFunction(inLLVMFunction)
 		, irBuilder(context)
 		{}
@@ -257,7 +269,9 @@ namespace LLVMJIT
 			assert(intrinsicObject);
 			FunctionInstance* intrinsicFunction = asFunction(intrinsicObject);
 			assert(intrinsicFunction->type == intrinsicType);
-			auto intrinsicFunctionPointer = emitLiteralPointer(intrinsicFunction->nativeFunction,asLLVMType(intrinsicType)->getPointerTo());
+			auto intrinsicFunctionPointer = moduleContext.getFunctionSymbol(
+				Symbols::intrinsicPrefix + Intrinsics::getDecoratedName(intrinsicName,intrinsicType),
+				asLLVMType(intrinsicType));
 			return irBuilder.CreateCall(intrinsicFunctionPointer,llvm::ArrayRef<llvm::Value*>(args.begin(),args.end()));
 		}
 
@@ -591,9 +605,8 @@ namespace LLVMJIT
 			const FunctionType* calleeType;
 			if(imm.functionIndex < moduleContext.importedFunctionPointers.size())
 			{
-				assert(imm.functionIndex < moduleContext.moduleInstance->functions.size());
 				callee = moduleContext.importedFunctionPointers[imm.functionIndex];
-				calleeType = moduleContext.moduleInstance->functions[imm.functionIndex]->type;
+				calleeType = module.types[module.functions.imports[imm.functionIndex].type.index];
 			}
 			else
 			{
@@ -638,7 +651,7 @@ namespace LLVMJIT
 			// Load the type for this table entry.
 			auto functionTypePointerPointer = irBuilder.CreateInBoundsGEP(moduleContext.defaultTablePointer,{functionIndexZExt,emitLiteral((U32)0)});
 			auto functionTypePointer = irBuilder.CreateLoad(functionTypePointerPointer);
-			auto llvmCalleeType = emitLiteralPointer(calleeType,llvmI8PtrType);
+			auto llvmCalleeType = moduleContext.getSymbol(Symbols::typePrefix + std::to_string(imm.type.index),llvmI8Type);
 			
 			// If the function type doesn't match, trap.
 			emitConditionalTrapIntrinsic(
@@ -647,7 +660,7 @@ namespace LLVMJIT
 				FunctionType::get(ResultType::none,{ValueType::i32,ValueType::i64,ValueType::i64}),
 				{	tableElementIndex,
 					irBuilder.CreatePtrToInt(llvmCalleeType,llvmI64Type),
-					emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultTable))	}
+					moduleContext.defaultTableObjectAsI64	}
 				);
 
 			// Call the function loaded from the table.
@@ -701,7 +714,7 @@ namespace LLVMJIT
 		void grow_memory(MemoryImm)
 		{
 			auto deltaNumPages = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.defaultMemoryObjectAsI64;
 			auto previousNumPages = emitRuntimeIntrinsic(
 				"wavmIntrinsics.growMemory",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i64}),
@@ -710,7 +723,7 @@ namespace LLVMJIT
 		}
 		void current_memory(MemoryImm)
 		{
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.defaultMemoryObjectAsI64;
 			auto currentNumPages = emitRuntimeIntrinsic(
 				"wavmIntrinsics.currentMemory",
 				FunctionType::get(ResultType::i32,{ValueType::i64}),
@@ -1199,7 +1212,7 @@ namespace LLVMJIT
 		{
 			auto numWaiters = pop();
 			auto address = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.defaultMemoryObjectAsI64;
 			push(emitRuntimeIntrinsic(
 				"wavmIntrinsics.wake",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i32,ValueType::i64}),
@@ -1210,7 +1223,7 @@ namespace LLVMJIT
 			auto timeout = pop();
 			auto expectedValue = pop();
 			auto address = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.defaultMemoryObjectAsI64;
 			push(emitRuntimeIntrinsic(
 				"wavmIntrinsics.wait",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i32,ValueType::f64,ValueType::i64}),
@@ -1221,7 +1234,7 @@ namespace LLVMJIT
 			auto timeout = pop();
 			auto expectedValue = pop();
 			auto address = pop();
-			auto defaultMemoryObjectAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultMemory));
+			auto defaultMemoryObjectAsI64 = moduleContext.defaultMemoryObjectAsI64;
 			push(emitRuntimeIntrinsic(
 				"wavmIntrinsics.wait",
 				FunctionType::get(ResultType::i32,{ValueType::i32,ValueType::i64,ValueType::f64,ValueType::i64}),
@@ -1230,11 +1243,11 @@ namespace LLVMJIT
 
 		void launch_thread(LaunchThreadImm)
 		{
-			assert(moduleContext.moduleInstance->defaultTable);
+			assert(moduleContext.defaultTableObjectAsI64);
 			auto errorFunctionIndex = pop();
 			auto argument = pop();
 			auto functionIndex = pop();
-			auto defaultTableAsI64 = emitLiteral(reinterpret_cast<U64>(moduleContext.moduleInstance->defaultTable));
+			auto defaultTableAsI64 = moduleContext.defaultTableObjectAsI64;
 			emitRuntimeIntrinsic(
 				"wavmIntrinsics.launchThread",
 				FunctionType::get(ResultType::none,{ValueType::i32,ValueType::i32,ValueType::i32,ValueType::i64}),
@@ -1451,7 +1464,7 @@ namespace LLVMJIT
 		auto diFunctionType = moduleContext.diBuilder.createSubroutineType(moduleContext.diBuilder.getOrCreateTypeArray(diFunctionParameterTypes));
 		diFunction = moduleContext.diBuilder.createFunction(
 			moduleContext.diModuleScope,
-			functionInstance->debugName,
+			moduleContext.functionDefDebugNames[functionDefIndex],
 			llvmFunction->getName(),
 			moduleContext.diModuleScope,
 			0,
@@ -1477,7 +1490,9 @@ namespace LLVMJIT
 			emitRuntimeIntrinsic(
 				"wavmIntrinsics.debugEnterFunction",
 				FunctionType::get(ResultType::none,{ValueType::i64}),
-				{emitLiteral(reinterpret_cast<U64>(functionInstance))}
+				{llvm::ConstantExpr::getPtrToInt(
+					moduleContext.getSymbol(Symbols::functionDefPrefix + std::to_string(functionDefIndex),llvmI8Type),
+					llvmI64Type)}
 				);
 		}
 
@@ -1528,7 +1543,9 @@ namespace LLVMJIT
 			emitRuntimeIntrinsic(
 				"wavmIntrinsics.debugExitFunction",
 				FunctionType::get(ResultType::none,{ValueType::i64}),
-				{emitLiteral(reinterpret_cast<U64>(functionInstance))}
+				{llvm::ConstantExpr::getPtrToInt(
+					moduleContext.getSymbol(Symbols::functionDefPrefix + std::to_string(functionDefIndex),llvmI8Type),
+					llvmI64Type)}
 				);
 		}
 
@@ -1541,53 +1558,66 @@ namespace LLVMJIT
 	{
 		Timing::Timer emitTimer;
 
-		// Create literals for the default memory base and mask.
-		if(moduleInstance->defaultMemory)
+		// Create symbols for the default memory base and object, and a literal for the mask.
+		// The memory base is declared as an array spanning the memory's reserved address-space, so accesses to it are in bounds.
+		if(module.memories.imports.size() + module.memories.defs.size())
 		{
-			defaultMemoryBase = emitLiteralPointer(moduleInstance->defaultMemory->baseAddress,llvmI8PtrType);
-			const Uptr defaultMemoryAddressMaskValue = Uptr(moduleInstance->defaultMemory->endOffset) - 1;
-			defaultMemoryAddressMask = emitLiteral(defaultMemoryAddressMaskValue);
+			defaultMemoryBase = llvm::ConstantExpr::getPointerCast(
+				getSymbol(Symbols::defaultMemoryBase,llvm::ArrayType::get(llvmI8Type,memoryMaxBytes)),
+				llvmI8PtrType);
+			defaultMemoryAddressMask = emitLiteral(memoryMaxBytes - 1);
+			defaultMemoryObjectAsI64 = llvm::ConstantExpr::getPtrToInt(getSymbol(Symbols::defaultMemory,llvmI8Type),llvmI64Type);
 		}
-		else { defaultMemoryBase = defaultMemoryAddressMask = nullptr; }
+		else { defaultMemoryBase = defaultMemoryAddressMask = defaultMemoryObjectAsI64 = nullptr; }
 
 		// Set up the LLVM values used to access the global table.
-		if(moduleInstance->defaultTable)
+		if(module.tables.imports.size() + module.tables.defs.size())
 		{
 			auto tableElementType = llvm::StructType::get(context,{
 				llvmI8PtrType,
 				llvmI8PtrType
 				});
-			defaultTablePointer = emitLiteralPointer(moduleInstance->defaultTable->baseAddress,tableElementType->getPointerTo());
-			defaultTableEndOffset = emitLiteral((Uptr)moduleInstance->defaultTable->endOffset);
+			const Uptr numTableElements = tableMaxBytes / sizeof(TableInstance::FunctionElement);
+			defaultTablePointer = llvm::ConstantExpr::getPointerCast(
+				getSymbol(Symbols::defaultTableBase,llvm::ArrayType::get(tableElementType,numTableElements)),
+				tableElementType->getPointerTo());
+			defaultTableEndOffset = emitLiteral(tableMaxBytes);
+			defaultTableObjectAsI64 = llvm::ConstantExpr::getPtrToInt(getSymbol(Symbols::defaultTable,llvmI8Type),llvmI64Type);
 		}
 		else
 		{
-			defaultTablePointer = defaultTableEndOffset = nullptr;
+			defaultTablePointer = defaultTableEndOffset = defaultTableObjectAsI64 = nullptr;
 		}
 
-		// Create LLVM pointer constants for the module's imported functions.
+		// Create symbols for the module's imported functions.
 		for(Uptr functionIndex = 0;functionIndex < module.functions.imports.size();++functionIndex)
 		{
-			const FunctionInstance* functionInstance = moduleInstance->functions[functionIndex];
-			importedFunctionPointers.push_back(emitLiteralPointer(functionInstance->nativeFunction,asLLVMType(functionInstance->type)->getPointerTo()));
+			const FunctionType* functionType = module.types[module.functions.imports[functionIndex].type.index];
+			importedFunctionPointers.push_back(getFunctionSymbol(Symbols::importPrefix + std::to_string(functionIndex),asLLVMType(functionType)));
 		}
 
-		// Create LLVM pointer constants for the module's globals.
-		for(auto global : moduleInstance->globals)
-		{ globalPointers.push_back(emitLiteralPointer(&global->value,asLLVMType(global->type.valueType)->getPointerTo())); }
+		// Create symbols for the module's globals: its imported globals, followed by its global definitions.
+		for(Uptr globalIndex = 0;globalIndex < module.globals.imports.size() + module.globals.defs.size();++globalIndex)
+		{
+			const GlobalType& globalType = globalIndex < module.globals.imports.size()
+				? module.globals.imports[globalIndex].type
+				: module.globals.defs[globalIndex - module.globals.imports.size()].type;
+			globalPointers.push_back(getSymbol(Symbols::globalPrefix + std::to_string(globalIndex),asLLVMType(globalType.valueType)));
+		}
 		
 		// Create the LLVM functions.
 		functionDefs.resize(module.functions.defs.size());
+		functionDefDebugNames = getFunctionDefDebugNames(module);
 		for(Uptr functionDefIndex = 0;functionDefIndex < module.functions.defs.size();++functionDefIndex)
 		{
 			auto llvmFunctionType = asLLVMType(module.types[module.functions.defs[functionDefIndex].type.index]);
-			auto externalName = getExternalFunctionName(moduleInstance,functionDefIndex);
+			auto externalName = getExternalFunctionName(functionDefIndex,functionDefDebugNames[functionDefIndex]);
 			functionDefs[functionDefIndex] = llvm::Function::Create(llvmFunctionType,llvm::Function::ExternalLinkage,externalName,llvmModule);
 		}
 
 		// Compile each function in the module.
 		for(Uptr functionDefIndex = 0;functionDefIndex < module.functions.defs.size();++functionDefIndex)
-		{ EmitFunctionContext(*this,module,module.functions.defs[functionDefIndex],moduleInstance->functionDefs[functionDefIndex],functionDefs[functionDefIndex]).emit(); }
+		{ EmitFunctionContext(*this,module,functionDefIndex,functionDefs[functionDefIndex]).emit(); }
 		
 		// Finalize the debug info.
 		diBuilder.finalize();
@@ -1597,8 +1627,8 @@ namespace LLVMJIT
 		return llvmModule;
 	}
 
-	llvm::Module* emitModule(const Module& module,ModuleInstance* moduleInstance)
+	llvm::Module* emitModule(const Module& module)
 	{
-		return EmitModuleContext(module,moduleInstance).emit();
+		return EmitModuleContext(module).emit();
 	}
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "Logging/Logging.h"
 #include "RuntimePrivate.h"
 
+#include "llvm/Config/llvm-config.h"
+
 #ifdef _DEBUG
 	// This needs to be 1 to allow debuggers such as Visual Studio to place breakpoints and step through the JITed code.
 	#define USE_WRITEABLE_JIT_CODE_PAGES 1
@@ -48,7 +50,13 @@ namespace LLVMJIT
 	#endif
 
 	llvm::Constant* typedZeroConstants[(Uptr)ValueType::num];
+
+	// The version of the generated object code; incremented when changes to the IR emitter make cached object code invalid.
+	static const Uptr objectCodeVersion = 1;
 	
+	// Serializes the use of the LLVM context and target machine, which are shared by all threads.
+	Platform::Mutex* llvmMutex = Platform::createMutex();
+
 	// A map from address to loaded JIT symbols.
 	Platform::Mutex* addressToSymbolMapMutex = Platform::createMutex();
 	std::map<Uptr,struct JITSymbol*> addressToSymbolMap;
@@ -208,12 +216,35 @@ namespace LLVMJIT
 		void operator=(const UnitMemoryManager&) = delete;
 	};
 
+	// Used to override LLVM's default behavior of looking up unresolved symbols in DLL exports.
+	struct NullResolver : llvm::JITSymbolResolver
+	{
+		static NullResolver singleton;
+		virtual llvm::JITSymbol findSymbol(const std::string& name) override;
+		virtual llvm::JITSymbol findSymbolInLogicalDylib(const std::string& name) override;
+	};
+	
+	// Captures the object code that the JIT compiler generates for a module.
+	struct ObjectCodeCapture : llvm::ObjectCache
+	{
+		std::vector<U8>& objectCode;
+
+		ObjectCodeCapture(std::vector<U8>& inObjectCode): objectCode(inObjectCode) {}
+
+		void notifyObjectCompiled(const llvm::Module* llvmModule,llvm::MemoryBufferRef object) override
+		{
+			objectCode.assign((const U8*)object.getBufferStart(),(const U8*)object.getBufferEnd());
+		}
+		std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* llvmModule) override { return nullptr; }
+	};
+
 	// A unit of JIT compilation.
 	// Encapsulates the LLVM JIT compilation pipeline but allows subclasses to define how the resulting code is used.
 	struct JITUnit
 	{
 		JITUnit(bool inShouldLogMetrics = true)
-		: shouldLogMetrics(inShouldLogMetrics)
+		: resolver(&NullResolver::singleton)
+		, shouldLogMetrics(inShouldLogMetrics)
 		#ifdef _WIN32
 			, pdataCopy(nullptr)
 		#endif
@@ -230,10 +261,19 @@ namespace LLVMJIT
 			#endif
 		}
 
-		void compile(llvm::Module* llvmModule);
+		// Compiles and links a module. If outObjectCode isn't null, the generated object code is copied to it.
+		void compile(llvm::Module* llvmModule,std::vector<U8>* outObjectCode = nullptr);
+
+		// Links object code generated by compile. Returns false if it isn't a valid object file.
+		bool load(const std::vector<U8>& objectCode);
 
 		virtual void notifySymbolLoaded(const char* name,Uptr baseAddress,Uptr numBytes,std::map<U32,U32>&& offsetToOpIndexMap) = 0;
 
+	protected:
+
+		// Resolves the external symbols referenced by the unit's code.
+		llvm::JITSymbolResolver* resolver;
+
 	private:
 		
 		// Functor that receives notifications when an object produced by the JIT is loaded.
@@ -280,11 +320,36 @@ namespace LLVMJIT
 	// The JIT compilation unit for a WebAssembly module instance.
 	struct JITModule : JITUnit, JITModuleBase
 	{
+		// Resolves the symbols the module's code uses to refer to its instance (see LLVMJIT::Symbols).
+		// Symbols are only resolved while the module is being compiled or loaded, when the IR::Module is still alive.
+		struct ModuleResolver : llvm::JITSymbolResolver
+		{
+			const IR::Module& module;
+			ModuleInstance* moduleInstance;
+
+			ModuleResolver(const IR::Module& inModule,ModuleInstance* inModuleInstance)
+			: module(inModule), moduleInstance(inModuleInstance) {}
+
+			virtual llvm::JITSymbol findSymbol(const std::string& name) override
+			{
+				Uptr address;
+				if(resolveModuleSymbol(module,moduleInstance,name,address)) { return llvm::JITSymbol(address,llvm::JITSymbolFlags::None); }
+				return NullResolver::singleton.findSymbol(name);
+			}
+			virtual llvm::JITSymbol findSymbolInLogicalDylib(const std::string& name) override { return llvm::JITSymbol(nullptr); }
+		};
+
 		ModuleInstance* moduleInstance;
+		ModuleResolver moduleResolver;
 
 		std::vector<JITSymbol*> functionDefSymbols;
 
-		JITModule(ModuleInstance* inModuleInstance): moduleInstance(inModuleInstance) {}
+		JITModule(const IR::Module& module,ModuleInstance* inModuleInstance)
+		: moduleInstance(inModuleInstance)
+		, moduleResolver(module,inModuleInstance)
+		{
+			resolver = &moduleResolver;
+		}
 		~JITModule() override
 		{
 			// Delete the module's symbols, and remove them from the global address-to-symbol map.
@@ -333,14 +398,6 @@ namespace LLVMJIT
 		}
 	};
 	
-	// Used to override LLVM's default behavior of looking up unresolved symbols in DLL exports.
-	struct NullResolver : llvm::JITSymbolResolver
-	{
-		static NullResolver singleton;
-		virtual llvm::JITSymbol findSymbol(const std::string& name) override;
-		virtual llvm::JITSymbol findSymbolInLogicalDylib(const std::string& name) override;
-	};
-	
 	NullResolver NullResolver::singleton;
 	llvm::JITSymbol NullResolver::findSymbol(const std::string& name)
 	{
@@ -476,7 +533,8 @@ namespace LLVMJIT
 		Log::printf(Log::Category::debug,"Dumped LLVM module to: %s\n",augmentedFilename.c_str());
 	}
 
-	void JITUnit::compile(llvm::Module* llvmModule)
+	// Verifies and optimizes a module before it is passed to the code generator.
+	static void optimizeModule(llvm::Module* llvmModule,bool shouldLogMetrics)
 	{
 		// Get a target machine object for this host, and set the module to use its data layout.
 		llvmModule->setDataLayout(targetMachine->createDataLayout());
@@ -512,14 +570,26 @@ namespace LLVMJIT
 		}
 
 		if(DUMP_OPTIMIZED_MODULE) { printModule(llvmModule,"llvmOptimizedDump"); }
+	}
+
+	void JITUnit::compile(llvm::Module* llvmModule,std::vector<U8>* outObjectCode)
+	{
+		optimizeModule(llvmModule,shouldLogMetrics);
 
 		// Pass the module to the JIT compiler.
 		Timing::Timer machineCodeTimer;
+		std::unique_ptr<ObjectCodeCapture> objectCodeCapture;
+		if(outObjectCode)
+		{
+			objectCodeCapture = llvm::make_unique<ObjectCodeCapture>(*outObjectCode);
+			compileLayer->setObjectCache(objectCodeCapture.get());
+		}
 		handle = compileLayer->addModuleSet(
 			std::vector<llvm::Module*>{llvmModule},
 			&memoryManager,
-			&NullResolver::singleton);
+			resolver);
 		compileLayer->emitAndFinalize(handle);
+		compileLayer->setObjectCache(nullptr);
 
 		if(shouldLogMetrics)
 		{
@@ -529,24 +599,145 @@ namespace LLVMJIT
 		delete llvmModule;
 	}
 
-	void instantiateModule(const IR::Module& module,ModuleInstance* moduleInstance)
+	bool JITUnit::load(const std::vector<U8>& objectCode)
 	{
-		// Emit LLVM IR for the module.
-		auto llvmModule = emitModule(module,moduleInstance);
+		Timing::Timer loadTimer;
+
+		auto objectBuffer = llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef((const char*)objectCode.data(),objectCode.size()));
+		auto object = llvm::object::ObjectFile::createObjectFile(objectBuffer->getMemBufferRef());
+		if(!object)
+		{
+			llvm::consumeError(object.takeError());
+			return false;
+		}
+
+		// Pass the object to the JIT linker, bypassing the compiler.
+		std::vector<std::unique_ptr<llvm::object::OwningBinary<llvm::object::ObjectFile>>> objectSet;
+		objectSet.push_back(llvm::make_unique<llvm::object::OwningBinary<llvm::object::ObjectFile>>(std::move(*object),std::move(objectBuffer)));
+		handle = objectLayer->addObjectSet(std::move(objectSet),&memoryManager,resolver);
+		objectLayer->emitAndFinalize(handle);
+
+		if(shouldLogMetrics)
+		{
+			Timing::logTimer("Loaded cached machine code",loadTimer);
+		}
+		return true;
+	}
+
+	// Qualifies an object cache key with everything besides the module that the generated code depends on.
+	static std::string getObjectCacheKey(const std::string& cacheKey)
+	{
+		return std::string("wavm-object-") + std::to_string(objectCodeVersion)
+			+ "/llvm-" + LLVM_VERSION_STRING
+			+ "/" + targetMachine->getTargetTriple().str()
+			+ "/" + targetMachine->getTargetCPU().str()
+			+ "/" + cacheKey;
+	}
+
+	void instantiateModule(const IR::Module& module,ModuleInstance* moduleInstance,ObjectCache* objectCache,const std::string& cacheKey)
+	{
+		Platform::Lock llvmLock(llvmMutex);
 
 		// Construct the JIT compilation pipeline for this module.
-		auto jitModule = new JITModule(moduleInstance);
+		auto jitModule = new JITModule(module,moduleInstance);
 		moduleInstance->jitModule = jitModule;
 
-		// Compile the module.
-		jitModule->compile(llvmModule);
+		// If the machine code for the module was cached, just link it.
+		std::string objectCacheKey;
+		if(objectCache)
+		{
+			objectCacheKey = getObjectCacheKey(cacheKey);
+			std::vector<U8> objectCode;
+			if(objectCache->load(objectCacheKey,objectCode) && jitModule->load(objectCode)) { return; }
+		}
+
+		// Emit LLVM IR for the module.
+		auto llvmModule = emitModule(module);
+
+		// Compile the module, and cache the machine code generated for it.
+		if(objectCache)
+		{
+			std::vector<U8> objectCode;
+			jitModule->compile(llvmModule,&objectCode);
+			if(objectCode.size()) { objectCache->store(objectCacheKey,objectCode); }
+		}
+		else { jitModule->compile(llvmModule); }
 	}
 
-	std::string getExternalFunctionName(ModuleInstance* moduleInstance,Uptr functionDefIndex)
+	void compileModule(const IR::Module& module,ObjectCache* objectCache,const std::string& cacheKey)
 	{
-		assert(functionDefIndex < moduleInstance->functionDefs.size());
-		return "wasmFunc" + std::to_string(functionDefIndex)
-			+ "_" + moduleInstance->functionDefs[functionDefIndex]->debugName;
+		Platform::Lock llvmLock(llvmMutex);
+
+		const std::string objectCacheKey = getObjectCacheKey(cacheKey);
+		std::vector<U8> objectCode;
+		if(objectCache->load(objectCacheKey,objectCode)) { return; }
+
+		// Generate the object code without loading it: it is linked into an instance when the module is instantiated.
+		auto llvmModule = emitModule(module);
+		optimizeModule(llvmModule,true);
+
+		Timing::Timer machineCodeTimer;
+		auto object = llvm::orc::SimpleCompiler(*targetMachine)(*llvmModule);
+		Timing::logRatePerSecond("Generated machine code",machineCodeTimer,(F64)llvmModule->size(),"functions");
+		delete llvmModule;
+
+		if(object.getBinary())
+		{
+			const llvm::MemoryBufferRef objectBuffer = object.getBinary()->getMemoryBufferRef();
+			objectCode.assign((const U8*)objectBuffer.getBufferStart(),(const U8*)objectBuffer.getBufferEnd());
+			objectCache->store(objectCacheKey,objectCode);
+		}
+	}
+
+	void deleteJITModule(JITModuleBase* jitModule)
+	{
+		// Unloading the module's machine code touches the JIT's LLVM state, which other threads may be using.
+		Platform::Lock llvmLock(llvmMutex);
+		delete jitModule;
+	}
+
+	bool resolveModuleSymbol(const IR::Module& module,ModuleInstance* moduleInstance,const std::string& name,Uptr& outAddress)
+	{
+		// Parses the index following a symbol prefix.
+		auto getSymbolIndex = [&name](const char* prefix,Uptr& outIndex) -> bool
+		{
+			const Uptr prefixLength = strlen(prefix);
+			if(name.compare(0,prefixLength,prefix) || name.size() == prefixLength) { return false; }
+			char* numberEnd = nullptr;
+			outIndex = std::strtoull(name.c_str() + prefixLength,&numberEnd,10);
+			return *numberEnd == 0;
+		};
+
+		Uptr index;
+		if(name == Symbols::defaultMemoryBase && moduleInstance->defaultMemory)
+		{ outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultMemory->baseAddress); }
+		else if(name == Symbols::defaultMemory && moduleInstance->defaultMemory)
+		{ outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultMemory); }
+		else if(name == Symbols::defaultTableBase && moduleInstance->defaultTable)
+		{ outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultTable->baseAddress); }
+		else if(name == Symbols::defaultTable && moduleInstance->defaultTable)
+		{ outAddress = reinterpret_cast<Uptr>(moduleInstance->defaultTable); }
+		else if(getSymbolIndex(Symbols::importPrefix,index) && index < module.functions.imports.size())
+		{ outAddress = reinterpret_cast<Uptr>(moduleInstance->functions[index]->nativeFunction); }
+		else if(getSymbolIndex(Symbols::globalPrefix,index) && index < moduleInstance->globals.size())
+		{ outAddress = reinterpret_cast<Uptr>(&moduleInstance->globals[index]->value); }
+		else if(getSymbolIndex(Symbols::typePrefix,index) && index < module.types.size())
+		{ outAddress = reinterpret_cast<Uptr>(module.types[index]); }
+		else if(getSymbolIndex(Symbols::functionDefPrefix,index) && index < moduleInstance->functionDefs.size())
+		{ outAddress = reinterpret_cast<Uptr>(moduleInstance->functionDefs[index]); }
+		else if(!name.compare(0,strlen(Symbols::intrinsicPrefix),Symbols::intrinsicPrefix))
+		{
+			FunctionInstance* intrinsicFunction = Intrinsics::findFunction(name.substr(strlen(Symbols::intrinsicPrefix)));
+			if(!intrinsicFunction) { return false; }
+			outAddress = reinterpret_cast<Uptr>(intrinsicFunction->nativeFunction);
+		}
+		else { return false; }
+		return true;
+	}
+
+	std::string getExternalFunctionName(Uptr functionDefIndex,const std::string& debugName)
+	{
+		return "wasmFunc" + std::to_string(functionDefIndex) + "_" + debugName;
 	}
 
 	bool getFunctionIndexFromExternalName(const char* externalName,Uptr& outFunctionDefIndex)
@@ -597,6 +788,8 @@ namespace LLVMJIT
 
 	InvokeFunctionPointer getInvokeThunk(const FunctionType* functionType)
 	{
+		Platform::Lock llvmLock(llvmMutex);
+
 		// Reuse cached invoke thunks for the same function type.
 		auto mapIt = invokeThunkTypeToSymbolMap.find(functionType);
 		if(mapIt != invokeThunkTypeToSymbolMap.end()) { return reinterpret_cast<InvokeFunctionPointer>(mapIt->second->baseAddress); }
@@ -671,7 +864,11 @@ namespace LLVMJIT
 			// our symbols can't be found in the JITed object file.
 			targetTriple += "-elf";
 		#endif
-		targetMachine = llvm::EngineBuilder().selectTarget(llvm::Triple(targetTriple),"","",llvm::SmallVector<std::string,0>());
+		// Use the large code model, so generated code can refer to symbols anywhere in the address-space:
+		// the runtime objects and intrinsics a module links against aren't necessarily near the code.
+		targetMachine = llvm::EngineBuilder()
+			.setCodeModel(llvm::CodeModel::Large)
+			.selectTarget(llvm::Triple(targetTriple),"","",llvm::SmallVector<std::string,0>());
 
 		llvmI8Type = llvm::Type::getInt8Ty(context);
 		llvmI16Type = llvm::Type::getInt16Ty(context);
@@ -25,6 +25,7 @@
 
 #include "llvm/Analysis/Passes.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
@@ -126,9 +127,27 @@ namespace LLVMJIT
 	}
 
 	// Functions that map between the symbols used for externally visible functions and the function
-	std::string getExternalFunctionName(ModuleInstance* moduleInstance,Uptr functionDefIndex);
+	std::string getExternalFunctionName(Uptr functionDefIndex,const std::string& debugName);
 	bool getFunctionIndexFromExternalName(const char* externalName,Uptr& outFunctionDefIndex);
 
-	// Emits LLVM IR for a module.
-	llvm::Module* emitModule(const IR::Module& module,ModuleInstance* moduleInstance);
+	// The external symbols that a module's code uses to refer to the objects of its instance and to the runtime intrinsics.
+	// They are resolved when the code is linked, so the same object code can be linked into any instance of the module.
+	namespace Symbols
+	{
+		static const char defaultMemoryBase[] = "wavm!defaultMemoryBase";
+		static const char defaultMemory[] = "wavm!defaultMemory";
+		static const char defaultTableBase[] = "wavm!defaultTableBase";
+		static const char defaultTable[] = "wavm!defaultTable";
+		static const char importPrefix[] = "wavm!import";		// Followed by the function import index.
+		static const char globalPrefix[] = "wavm!global";		// Followed by the global index.
+		static const char typePrefix[] = "wavm!type";			// Followed by the module type index.
+		static const char functionDefPrefix[] = "wavm!functionDef";	// Followed by the function definition index.
+		static const char intrinsicPrefix[] = "wavm!intrinsic!";	// Followed by the decorated intrinsic name.
+	}
+
+	// Resolves one of the above symbols for a module instance. Returns false if the name isn't one of them.
+	bool resolveModuleSymbol(const IR::Module& module,ModuleInstance* moduleInstance,const std::string& name,Uptr& outAddress);
+
+	// Emits LLVM IR for a module. The IR only depends on the module, not on any instance of it.
+	llvm::Module* emitModule(const IR::Module& module);
 }
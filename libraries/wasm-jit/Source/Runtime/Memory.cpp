@@ -8,6 +8,12 @@ namespace Runtime
 	// Global lists of memories; used to query whether an address is reserved by one of them.
 	std::vector<MemoryInstance*> memories;
 
+	static Platform::Mutex* getMemoriesMutex()
+	{
+		static Platform::Mutex* memoriesMutex = Platform::createMutex();
+		return memoriesMutex;
+	}
+
 	static Uptr getPlatformPagesPerWebAssemblyPageLog2()
 	{
 		errorUnless(Platform::getPageSizeLog2() <= IR::numBytesPerPageLog2);
@@ -28,11 +34,6 @@ namespace Runtime
 	{
 		MemoryInstance* memory = new MemoryInstance(type);
 
-		// On a 64-bit runtime, allocate 8GB of address space for the memory.
-		// This allows eliding bounds checks on memory accesses, since a 32-bit index + 32-bit offset will always be within the reserved address-space.
-		// On a 32-bit runtime, allocate 1GB.
-		const Uptr memoryMaxBytes = HAS_64BIT_ADDRESS_SPACE ? 8ull*1024*1024*1024 : 0x40000000;
-		
 		// On a 64 bit runtime, align the instance memory base to a 4GB boundary, so the lower 32-bits will all be zero. Maybe it will allow better code generation?
 		// Note that this reserves a full extra 4GB, but only uses (4GB-1 page) for alignment, so there will always be a guard page at the end to
 		// protect against unaligned loads/stores that straddle the end of the address-space.
@@ -45,6 +46,7 @@ namespace Runtime
 		if(growMemory(memory,type.size.min) == -1) { delete memory; return nullptr; }
 
 		// Add the memory to the global array.
+		Platform::Lock memoriesLock(getMemoriesMutex());
 		memories.push_back(memory);
 		return memory;
 	}
@@ -60,6 +62,7 @@ namespace Runtime
 		reservedNumPlatformPages = 0;
 
 		// Remove the memory from the global array.
+		Platform::Lock memoriesLock(getMemoriesMutex());
 		for(Uptr memoryIndex = 0;memoryIndex < memories.size();++memoryIndex)
 		{
 			if(memories[memoryIndex] == this) { memories.erase(memories.begin() + memoryIndex); break; }
@@ -69,6 +72,7 @@ namespace Runtime
 	bool isAddressOwnedByMemory(U8* address)
 	{
 		// Iterate over all memories and check if the address is within the reserved address space for each.
+		Platform::Lock memoriesLock(getMemoriesMutex());
 		for(auto memory : memories)
 		{
 			U8* startAddress = memory->reservedBaseAddress;
@@ -122,6 +126,33 @@ namespace Runtime
 		return previousNumPages;
 	}
 
+	struct MemorySnapshot
+	{
+		Uptr numPages;
+		Platform::PageSnapshot* pages;
+	};
+
+	MemorySnapshot* createMemorySnapshot(MemoryInstance* memory)
+	{
+		const Uptr numPages = memory->numPages;
+		auto pages = Platform::createPageSnapshot(memory->baseAddress,numPages << getPlatformPagesPerWebAssemblyPageLog2());
+		if(!pages) { return nullptr; }
+		return new MemorySnapshot {numPages,pages};
+	}
+
+	bool restoreMemorySnapshot(MemoryInstance* memory,MemorySnapshot* snapshot)
+	{
+		if(memory->numPages > snapshot->numPages && shrinkMemory(memory,memory->numPages - snapshot->numPages) == -1) { return false; }
+		if(memory->numPages < snapshot->numPages && growMemory(memory,snapshot->numPages - memory->numPages) == -1) { return false; }
+		return Platform::restorePageSnapshot(snapshot->pages,memory->baseAddress);
+	}
+
+	void deleteMemorySnapshot(MemorySnapshot* snapshot)
+	{
+		Platform::destroyPageSnapshot(snapshot->pages);
+		delete snapshot;
+	}
+
 	U8* getMemoryBaseAddress(MemoryInstance* memory)
 	{
 		return memory->baseAddress;
@@ -8,6 +8,12 @@
 namespace Runtime
 {
 	std::vector<ModuleInstance*> moduleInstances;
+
+	static Platform::Mutex* getModuleInstancesMutex()
+	{
+		static Platform::Mutex* moduleInstancesMutex = Platform::createMutex();
+		return moduleInstancesMutex;
+	}
 	
 	Value evaluateInitializer(ModuleInstance* moduleInstance,InitializerExpression expression)
 	{
@@ -28,7 +34,34 @@ namespace Runtime
 		};
 	}
 
+	std::vector<std::string> getFunctionDefDebugNames(const IR::Module& module)
+	{
+		// Get disassembly names for the module's objects.
+		DisassemblyNames disassemblyNames;
+		IR::getDisassemblyNames(module,disassemblyNames);
+
+		std::vector<std::string> debugNames;
+		for(Uptr functionDefIndex = 0;functionDefIndex < module.functions.defs.size();++functionDefIndex)
+		{
+			const Uptr functionIndex = module.functions.imports.size() + functionDefIndex;
+			std::string debugName = disassemblyNames.functions[functionIndex].name;
+			if(!debugName.size()) { debugName = "<function #" + std::to_string(functionDefIndex) + ">"; }
+			debugNames.push_back(std::move(debugName));
+		}
+		return debugNames;
+	}
+
+	void compileModule(const IR::Module& module,ObjectCache* objectCache,const std::string& cacheKey)
+	{
+		LLVMJIT::compileModule(module,objectCache,cacheKey);
+	}
+
 	ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports)
+	{
+		return instantiateModule(module,std::move(imports),nullptr,std::string());
+	}
+
+	ModuleInstance* instantiateModule(const IR::Module& module,ImportBindings&& imports,ObjectCache* objectCache,const std::string& cacheKey)
 	{
 		ModuleInstance* moduleInstance = new ModuleInstance(
 			std::move(imports.functions),
@@ -37,10 +70,6 @@ namespace Runtime
 			std::move(imports.globals)
 			);
 		
-		// Get disassembly names for the module's objects.
-		DisassemblyNames disassemblyNames;
-		IR::getDisassemblyNames(module,disassemblyNames);
-
 		// Check the type of the ModuleInstance's imports.
 		errorUnless(moduleInstance->functions.size() == module.functions.imports.size());
 		for(Uptr importIndex = 0;importIndex < module.functions.imports.size();++importIndex)
@@ -133,19 +162,16 @@ namespace Runtime
 		}
 		
 		// Create the FunctionInstance objects for the module's function definitions.
+		const std::vector<std::string> functionDefDebugNames = getFunctionDefDebugNames(module);
 		for(Uptr functionDefIndex = 0;functionDefIndex < module.functions.defs.size();++functionDefIndex)
 		{
-			const Uptr functionIndex = moduleInstance->functions.size();
-			const DisassemblyNames::Function& functionNames = disassemblyNames.functions[functionIndex];
-			std::string debugName = functionNames.name;
-			if(!debugName.size()) { debugName = "<function #" + std::to_string(functionDefIndex) + ">"; }
-			auto functionInstance = new FunctionInstance(moduleInstance,module.types[module.functions.defs[functionDefIndex].type.index],nullptr,debugName.c_str());
+			auto functionInstance = new FunctionInstance(moduleInstance,module.types[module.functions.defs[functionDefIndex].type.index],nullptr,functionDefDebugNames[functionDefIndex].c_str());
 			moduleInstance->functionDefs.push_back(functionInstance);
 			moduleInstance->functions.push_back(functionInstance);
 		}
 
 		// Generate machine code for the module.
-		LLVMJIT::instantiateModule(module,moduleInstance);
+		LLVMJIT::instantiateModule(module,moduleInstance,objectCache,cacheKey);
 
 		// Set up the instance's exports.
 		for(const Export& exportIt : module.exports)
@@ -187,13 +213,14 @@ namespace Runtime
 			invokeFunction(moduleInstance->functions[module.startFunctionIndex],{});
 		}
 
+		Platform::Lock moduleInstancesLock(getModuleInstancesMutex());
 		moduleInstances.push_back(moduleInstance);
 		return moduleInstance;
 	}
 
 	ModuleInstance::~ModuleInstance()
 	{
-		delete jitModule;
+		LLVMJIT::deleteJITModule(jitModule);
 	}
 
 	MemoryInstance* getDefaultMemory(ModuleInstance* moduleInstance) { return moduleInstance->defaultMemory; }
@@ -83,6 +83,12 @@ namespace Runtime
 	}
 
 
+	static LLVMJIT::InvokeFunctionPointer getInvokeThunk(FunctionInstance* function)
+	{
+		if(!function->invokeThunk) { function->invokeThunk = LLVMJIT::getInvokeThunk(function->type); }
+		return function->invokeThunk;
+	}
+
 	Result invokeFunction(FunctionInstance* function,const std::vector<Value>& parameters)
 	{
 		const FunctionType* functionType = function->type;
@@ -105,7 +111,7 @@ namespace Runtime
 		}
 		
 		// Get the invoke thunk for this function type.
-		LLVMJIT::InvokeFunctionPointer invokeFunctionPointer = LLVMJIT::getInvokeThunk(functionType);
+		LLVMJIT::InvokeFunctionPointer invokeFunctionPointer = getInvokeThunk(function);
 
 		// Catch platform-specific runtime exceptions and turn them into Runtime::Values.
 		Result result;
@@ -131,6 +137,33 @@ namespace Runtime
 		else { handleHardwareTrap(trapType,std::move(trapCallStack),trapOperand); }
 	}
 
+	void invokeNullaryFunction(FunctionInstance* function)
+	{
+		const FunctionType* functionType = function->type;
+		if(functionType->parameters.size()) { throw Exception {Exception::Cause::invokeSignatureMismatch}; }
+
+		// The thunk writes the result, if any, to the memory block following the (absent) parameters.
+		struct InvokeContext
+		{
+			LLVMJIT::InvokeFunctionPointer invokeFunctionPointer;
+			void* nativeFunction;
+			U64 thunkMemory[1];
+		};
+		InvokeContext context = {getInvokeThunk(function),function->nativeFunction,{0}};
+
+		// Capture only a pointer, so the lambda fits in std::function's inline storage instead of being heap allocated.
+		InvokeContext* contextPointer = &context;
+		Platform::CallStack trapCallStack;
+		Uptr trapOperand;
+		Platform::HardwareTrapType trapType = Platform::catchHardwareTraps(trapCallStack,trapOperand,
+			[contextPointer]
+			{
+				(*contextPointer->invokeFunctionPointer)(contextPointer->nativeFunction,contextPointer->thunkMemory);
+			});
+
+		if(trapType != Platform::HardwareTrapType::none) { handleHardwareTrap(trapType,std::move(trapCallStack),trapOperand); }
+	}
+
 	const FunctionType* getFunctionType(FunctionInstance* function)
 	{
 		return function->type;
@@ -20,7 +20,9 @@ namespace LLVMJIT
 	};
 
 	void init();
-	void instantiateModule(const IR::Module& module,Runtime::ModuleInstance* moduleInstance);
+	void instantiateModule(const IR::Module& module,Runtime::ModuleInstance* moduleInstance,Runtime::ObjectCache* objectCache,const std::string& cacheKey);
+	void compileModule(const IR::Module& module,Runtime::ObjectCache* objectCache,const std::string& cacheKey);
+	void deleteJITModule(JITModuleBase* jitModule);
 	bool describeInstructionPointer(Uptr ip,std::string& outDescription);
 	
 	typedef void (*InvokeFunctionPointer)(void*,U64*);
@@ -47,6 +49,8 @@ namespace Runtime
 		const FunctionType* type;
 		void* nativeFunction;
 		std::string debugName;
+		// The invoke thunk for the function's type, looked up on the first invocation.
+		LLVMJIT::InvokeFunctionPointer invokeThunk = nullptr;
 
 		FunctionInstance(ModuleInstance* inModuleInstance,const FunctionType* inType,void* inNativeFunction = nullptr,const char* inDebugName = "<unidentified FunctionInstance>")
 		: GCObject(ObjectKind::function), moduleInstance(inModuleInstance), type(inType), nativeFunction(inNativeFunction), debugName(inDebugName) {}
@@ -76,6 +80,9 @@ namespace Runtime
 		~TableInstance() override;
 	};
 
+	// In 64-bit, allocate enough address-space to safely access 32-bit table indices without bounds checking, or 16MB (4M elements) if the host is 32-bit.
+	static const Uptr tableMaxBytes = HAS_64BIT_ADDRESS_SPACE ? (sizeof(TableInstance::FunctionElement) << 32) : 16*1024*1024;
+
 	// An instance of a WebAssembly Memory.
 	struct MemoryInstance : GCObject
 	{
@@ -92,6 +99,11 @@ namespace Runtime
 		~MemoryInstance() override;
 	};
 
+	// On a 64-bit runtime, allocate 8GB of address space for each memory.
+	// This allows eliding bounds checks on memory accesses, since a 32-bit index + 32-bit offset will always be within the reserved address-space.
+	// On a 32-bit runtime, allocate 1GB.
+	static const Uptr memoryMaxBytes = HAS_64BIT_ADDRESS_SPACE ? 8ull*1024*1024*1024 : 0x40000000;
+
 	// An instance of a WebAssembly global.
 	struct GlobalInstance : GCObject
 	{
@@ -140,6 +152,9 @@ namespace Runtime
 	// Initializes global state used by the WAVM intrinsics.
 	void initWAVMIntrinsics();
 
+	// Returns the names that describe a module's function definitions in call stacks and debug info.
+	std::vector<std::string> getFunctionDefDebugNames(const IR::Module& module);
+
 	// Checks whether an address is owned by a table or memory.
 	bool isAddressOwnedByTable(U8* address);
 	bool isAddressOwnedByMemory(U8* address);
@@ -8,6 +8,12 @@ namespace Runtime
 	// Global lists of tables; used to query whether an address is reserved by one of them.
 	std::vector<TableInstance*> tables;
 
+	static Platform::Mutex* getTablesMutex()
+	{
+		static Platform::Mutex* tablesMutex = Platform::createMutex();
+		return tablesMutex;
+	}
+
 	static Uptr getNumPlatformPages(Uptr numBytes)
 	{
 		return (numBytes + (Uptr(1)<<Platform::getPageSizeLog2()) - 1) >> Platform::getPageSizeLog2();
@@ -17,9 +23,6 @@ namespace Runtime
 	{
 		TableInstance* table = new TableInstance(type);
 
-		// In 64-bit, allocate enough address-space to safely access 32-bit table indices without bounds checking, or 16MB (4M elements) if the host is 32-bit.
-		const Uptr tableMaxBytes = HAS_64BIT_ADDRESS_SPACE ? (sizeof(TableInstance::FunctionElement) << 32) : 16*1024*1024;
-		
 		// On a 64 bit runtime, align the table base to a 4GB boundary, so the lower 32-bits will all be zero. Maybe it will allow better code generation?
 		// Note that this reserves a full extra 4GB, but only uses (4GB-1 page) for alignment, so there will always be a guard page at the end to
 		// protect against unaligned loads/stores that straddle the end of the address-space.
@@ -32,6 +35,7 @@ namespace Runtime
 		if(growTable(table,type.size.min) == -1) { delete table; return nullptr; }
 		
 		// Add the table to the global array.
+		Platform::Lock tablesLock(getTablesMutex());
 		tables.push_back(table);
 		return table;
 	}
@@ -48,6 +52,7 @@ namespace Runtime
 		baseAddress = nullptr;
 		
 		// Remove the table from the global array.
+		Platform::Lock tablesLock(getTablesMutex());
 		for(Uptr tableIndex = 0;tableIndex < tables.size();++tableIndex)
 		{
 			if(tables[tableIndex] == this) { tables.erase(tables.begin() + tableIndex); break; }
@@ -57,6 +62,7 @@ namespace Runtime
 	bool isAddressOwnedByTable(U8* address)
 	{
 		// Iterate over all tables and check if the address is within the reserved address space for each.
+		Platform::Lock tablesLock(getTablesMutex());
 		for(auto table : tables)
 		{
 			U8* startAddress = (U8*)table->reservedBaseAddress;
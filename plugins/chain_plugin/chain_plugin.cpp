@@ -3,6 +3,7 @@
 #include <eos/chain/block_log.hpp>
 #include <eos/chain/exceptions.hpp>
 #include <eos/chain/producer_object.hpp>
+#include <eos/chain/wasm_interface.hpp>
 
 #include <eos/native_contract/native_contract_chain_initializer.hpp>
 #include <eos/native_contract/native_contract_chain_administrator.hpp>
@@ -25,6 +26,8 @@ public:
    bfs::path                        block_log_dir;
    bfs::path                        genesis_file;
    bool                             readonly = false;
+   bool                             store_transaction_bodies = true;
+   uint32_t                         block_log_sync_interval = 0;
    flat_map<uint32_t,block_id_type> loaded_checkpoints;
 
    fc::optional<fork_database>      fork_db;
@@ -47,6 +50,10 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
          ("block-log-dir", bpo::value<bfs::path>()->default_value("blocks"),
           "the location of the block log (absolute path or relative to application data dir)")
          ("checkpoint,c", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
+         ("store-transaction-bodies", bpo::value<bool>()->default_value(true),
+          "Keep recent transactions whole in the chain database, rather than only their IDs for duplicate detection")
+         ("block-log-sync-interval", bpo::value<uint32_t>()->default_value(0),
+          "Sync the block log to disk after every this many irreversible blocks (0 to leave it to the operating system)")
          ;
    cli.add_options()
          ("replay-blockchain", bpo::bool_switch()->default_value(false),
@@ -80,6 +87,9 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
       fc::remove_all(my->block_log_dir);
    }
 
+   my->store_transaction_bodies = options.at("store-transaction-bodies").as<bool>();
+   my->block_log_sync_interval = options.at("block-log-sync-interval").as<uint32_t>();
+
    if(options.count("checkpoint"))
    {
       auto cps = options.at("checkpoint").as<vector<string>>();
@@ -95,19 +105,23 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
 void chain_plugin::plugin_startup() {
    auto& db = app().get_plugin<database_plugin>().db();
 
+   // Compiled contracts are cached next to the database, so restarts don't have to compile them again
+   chain::wasm_interface::set_code_cache_dir(app().get_plugin<database_plugin>().shared_memory_dir() / "code_cache");
+
    auto genesis = fc::json::from_file(my->genesis_file).as<native_contract::genesis_state_type>();
    native_contract::native_contract_chain_initializer initializer(genesis);
 
    my->fork_db = fork_database();
    my->block_logger = block_log(my->block_log_dir);
    my->chain_id = genesis.compute_chain_id();
-   my->chain = chain_controller(db, *my->fork_db, *my->block_logger,
-                                initializer, native_contract::make_administrator());
-
-   if(!my->readonly) {
+   // Checkpoints are handed over at construction, so that replaying the block log can skip the blocks they cover
+   if(!my->readonly)
       ilog("starting chain in read/write mode");
-      my->chain->add_checkpoints(my->loaded_checkpoints);
-   }
+   my->chain = chain_controller(db, *my->fork_db, *my->block_logger,
+                                initializer, native_contract::make_administrator(),
+                                my->readonly? flat_map<uint32_t,block_id_type>() : my->loaded_checkpoints);
+   my->chain->set_store_transaction_bodies(my->store_transaction_bodies);
+   my->chain->set_block_log_sync_interval(my->block_log_sync_interval);
 
    ilog("Blockchain started; head block is #${num}", ("num", my->chain->head_block_num()));
 }
@@ -126,8 +140,22 @@ bool chain_plugin::accept_block(const chain::signed_block& block, bool currently
    return chain().push_block(block);
 }
 
+std::vector<bool> chain_plugin::accept_blocks(const std::vector<chain::signed_block>& blocks, bool currently_syncing) {
+   if (blocks.empty())
+      return {};
+   if (currently_syncing && blocks.front().block_num() / 10000 != blocks.back().block_num() / 10000) {
+      ilog("Syncing Blockchain --- Got blocks: #${f} to #${n} time: ${t} producer: ${p}",
+           ("t", blocks.back().timestamp)
+           ("f", blocks.front().block_num())
+           ("n", blocks.back().block_num())
+           ("p", blocks.back().producer));
+   }
+
+   return chain().push_blocks(blocks);
+}
+
 void chain_plugin::accept_transaction(const chain::SignedTransaction& trx) {
-   chain().push_transaction(trx);
+   chain().push_transaction(chain::transaction_metadata(trx));
 }
 
 bool chain_plugin::block_is_on_preferred_chain(const chain::block_id_type& block_id) {
@@ -147,24 +175,30 @@ const chain::chain_controller& chain_plugin::chain() const { return *my->chain;
 
 namespace chain_apis {
 
+// The read only API is called from the HTTP thread, while blocks are applied on the application thread. Reads must
+// therefore go through the published head block state, or hold the database read lock.
+
 read_only::get_info_results read_only::get_info(const read_only::get_info_params&) const {
+   auto head = db.get_head_block_state();
    return {
-      db.head_block_num(),
-      db.head_block_id(),
-      db.head_block_time(),
-      db.head_block_producer(),
-      std::bitset<64>(db.get_dynamic_global_properties().recent_slots_filled).to_string(),
-      __builtin_popcountll(db.get_dynamic_global_properties().recent_slots_filled) / 64.0
+      head->head_block_num,
+      head->head_block_id,
+      head->head_block_time,
+      head->head_block_producer,
+      std::bitset<64>(head->recent_slots_filled).to_string(),
+      __builtin_popcountll(head->recent_slots_filled) / 64.0
    };
 }
 
 read_only::get_block_results read_only::get_block(const read_only::get_block_params& params) const {
    try {
-      if (auto block = db.fetch_block_by_id(fc::json::from_string(params.block_num_or_id).as<chain::block_id_type>()))
+      auto id = fc::json::from_string(params.block_num_or_id).as<chain::block_id_type>();
+      if (auto block = db.with_read_lock([&]() { return db.fetch_block_by_id(id); }))
          return *block;
    } catch (fc::bad_cast_exception) {/* do nothing */}
    try {
-      if (auto block = db.fetch_block_by_number(fc::to_uint64(params.block_num_or_id)))
+      auto num = fc::to_uint64(params.block_num_or_id);
+      if (auto block = db.with_read_lock([&]() { return db.fetch_block_by_number(num); }))
          return *block;
    } catch (fc::bad_cast_exception) {/* do nothing */}
 
@@ -178,7 +212,7 @@ read_write::push_block_results read_write::push_block(const read_write::push_blo
 }
 
 read_write::push_transaction_results read_write::push_transaction(const read_write::push_transaction_params& params) {
-   db.push_transaction(params);
+   db.push_transaction(chain::transaction_metadata(params));
    return read_write::push_transaction_results();
 }
 
@@ -71,6 +71,8 @@ public:
    chain_apis::read_write get_read_write_api() { return chain_apis::read_write(chain()); }
 
    bool accept_block(const chain::signed_block& block, bool currently_syncing);
+   /// Accept a run of consecutive blocks, verifying later blocks while earlier ones are applied
+   std::vector<bool> accept_blocks(const std::vector<chain::signed_block>& blocks, bool currently_syncing);
    void accept_transaction(const chain::SignedTransaction& trx);
 
    bool block_is_on_preferred_chain(const chain::block_id_type& block_id);
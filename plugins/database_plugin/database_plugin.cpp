@@ -60,6 +60,10 @@ void database_plugin::plugin_shutdown() {
    ilog("database closed successfully");
 }
 
+const bfs::path& database_plugin::shared_memory_dir() const {
+   return my->shared_memory_dir;
+}
+
 chainbase::database& database_plugin::db() {
    assert(my->db.valid());
    return *my->db;
@@ -25,6 +25,9 @@ public:
    void plugin_shutdown();
 
 
+   // The directory holding the database files. This may only be called after plugin_initialize()!
+   const boost::filesystem::path& shared_memory_dir() const;
+
    // This may only be called after plugin_startup()!
    chainbase::database& db();
    // This may only be called after plugin_startup()!
@@ -1,4 +1,5 @@
 #include <eos/http_plugin/http_plugin.hpp>
+#include <eos/utilities/metrics.hpp>
 
 #include <fc/network/ip.hpp>
 #include <fc/log/logger_config.hpp>
@@ -101,6 +102,11 @@ namespace eos {
          my->listen_endpoint = tcp::endpoint(boost::asio::ip::address_v4::from_string((string)fcep.get_address()), fcep.port());
          ilog("configured http to listen on ${ep}", ("ep", fcep));
       }
+
+      // Expose the process's metrics to Prometheus
+      add_handler("/metrics", [](string, string, url_response_callback cb) {
+         cb(200, utilities::metrics_registry::get().prometheus_text());
+      });
    }
 
    void http_plugin::plugin_startup() {
@@ -53,6 +53,7 @@ public:
    bool _production_enabled = false;
    uint32_t _required_producer_participation = 33 * config::Percent1;
    uint32_t _production_skip_flags = eos::chain::chain_controller::skip_nothing;
+   uint32_t _block_execution_budget_ms = config::DefaultBlockExecutionBudgetMs;
 
    std::map<chain::public_key_type, fc::ecc::private_key> _private_keys;
    std::set<types::AccountName> _producers;
@@ -98,6 +99,8 @@ void producer_plugin::set_program_options(
    command_line_options.add_options()
          ("enable-stale-production", boost::program_options::bool_switch()->notifier([this](bool e){my->_production_enabled = e;}), "Enable block production, even if the chain is stale.")
          ("required-participation", boost::program_options::bool_switch()->notifier([this](int e){my->_required_producer_participation = uint32_t(e*config::Percent1);}), "Percent of producers (0-99) that must be participating in order to produce blocks")
+         ("block-execution-budget-ms", boost::program_options::value<uint32_t>()->default_value(config::DefaultBlockExecutionBudgetMs)->notifier([this](uint32_t ms){my->_block_execution_budget_ms = ms;}),
+          "Milliseconds of CPU time a produced block may take to apply; transactions over the budget wait for a later block (0 for no limit)")
          ("producer-name,p", boost::program_options::value<vector<string>>()->composing()->multitoken(),
           ("ID of producer controlled by this node (e.g. " + producer_id_example + ", quotes are required, may specify multiple times)").c_str())
          ("private-key", boost::program_options::value<vector<string>>()->composing()->multitoken()->default_value({fc::json::to_string(private_key_default)},
@@ -142,6 +145,7 @@ void producer_plugin::plugin_startup()
 { try {
    ilog("producer plugin:  plugin_startup() begin");
    chain::chain_controller& chain = app().get_plugin<chain_plugin>().chain();
+   chain.set_block_execution_budget(fc::milliseconds(my->_block_execution_budget_ms));
 
    if (!my->_producers.empty())
    {
@@ -107,6 +107,8 @@ void testing_blockchain::produce_blocks(uint32_t count, uint32_t blocks_to_miss)
       auto private_key = fixture.get_private_key(producer.signing_key);
       generate_block(get_slot_time(slot), producer.owner, private_key, 0);
    }
+   // Let tests read the blocks which became irreversible from the block log
+   flush_block_log();
 }
 
 void testing_blockchain::sync_with(testing_blockchain& other) {
@@ -151,6 +151,30 @@ public:
     */
    void produce_blocks(uint32_t count = 1, uint32_t blocks_to_miss = 0);
 
+   /**
+    * @brief Set whether the authorizations transactions declare are checked against their signatures
+    *
+    * Most tests push transactions without signing them, so authority checks are skipped unless enabled here. The skip
+    * flags apply to every block and transaction pushed or generated through this testing_blockchain.
+    */
+   void set_authority_checking(bool check) { skip_flags = check? skip_nothing : skip_authority_check; }
+
+   using chain_controller::push_block;
+   using chain_controller::push_transaction;
+   bool push_block(const signed_block& b, uint32_t skip = skip_nothing) {
+      return chain_controller::push_block(b, skip | skip_flags);
+   }
+   vector<bool> push_blocks(const vector<signed_block>& blocks, uint32_t skip = skip_nothing) {
+      return chain_controller::push_blocks(blocks, skip | skip_flags);
+   }
+   void push_transaction(const SignedTransaction& trx, uint32_t skip = skip_nothing) {
+      chain_controller::push_transaction(trx, skip | skip_flags);
+   }
+   signed_block generate_block(fc::time_point_sec when, const AccountName& producer,
+                               const fc::ecc::private_key& block_signing_private_key, uint32_t skip) {
+      return chain_controller::generate_block(when, producer, block_signing_private_key, skip | skip_flags);
+   }
+
    /**
     * @brief Sync this blockchain with other
     * @param other Blockchain to sync with
@@ -175,8 +199,11 @@ public:
    /// @brief Get the specified block producer's signing key
    PublicKey get_block_signing_key(const AccountName& producerName);
 
+   using chain_controller::get_block_log_writer;
+
 protected:
    testing_fixture& fixture;
+   uint32_t skip_flags = skip_authority_check;
 };
 
 using boost::signals2::scoped_connection;
@@ -21,16 +21,16 @@
 #define MKNET2_MACRO(x, name, chain) name.connect_blockchain(chain);
 #define MKNET2(name, ...) MKNET1(name) BOOST_PP_SEQ_FOR_EACH(MKNET2_MACRO, name, __VA_ARGS__)
 
-#define MKACCT_IMPL(chain, name, creator, active, owner, recovery, deposit) \
+#define MKACCT_IMPL(blockchain, name, creator, active, owner, recovery, deposit) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#creator, config::SystemContractName, \
                          vector<types::AccountName>{config::StakedBalanceContractName, \
                                                     config::EosContractName}, "CreateAccount", \
                          types::CreateAccount{#creator, #name, owner, active, recovery, deposit}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 #define MKACCT2(chain, name) \
    Make_Key(name) \
@@ -52,18 +52,18 @@
 #define MKACCT7(chain, name, creator, deposit, owner, active, recovery) \
    MKACCT_IMPL(chain, name, creator, owner, active, recovery, deposit)
 
-#define XFER5(chain, sender, recipient, amount, memo) \
+#define XFER5(blockchain, sender, recipient, amount, memo) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#sender, config::EosContractName, vector<AccountName>{#recipient}, "Transfer", \
                                 types::Transfer{#sender, #recipient, amount, memo}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 #define XFER4(chain, sender, recipient, amount) XFER5(chain, sender, recipient, amount, "")
 
-#define STAKE4(chain, sender, recipient, amount) \
+#define STAKE4(blockchain, sender, recipient, amount) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#sender, config::EosContractName, vector<AccountName>{config::StakedBalanceContractName}, \
@@ -72,63 +72,63 @@
          trx.messages.front().notify.emplace_back(#recipient); \
          boost::sort(trx.messages.front().notify); \
       } \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 #define STAKE3(chain, account, amount) STAKE4(chain, account, account, amount)
 
-#define BEGIN_UNSTAKE3(chain, account, amount) \
+#define BEGIN_UNSTAKE3(blockchain, account, amount) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#account, config::StakedBalanceContractName, vector<AccountName>{}, \
                          "StartUnlockEos", types::StartUnlockEos{#account, amount}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 
-#define FINISH_UNSTAKE3(chain, account, amount) \
+#define FINISH_UNSTAKE3(blockchain, account, amount) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#account, config::StakedBalanceContractName, vector<AccountName>{config::EosContractName}, \
                          "ClaimUnlockedEos", types::ClaimUnlockedEos{#account, amount}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 
-#define MKPDCR4(chain, owner, key, cfg) \
+#define MKPDCR4(blockchain, owner, key, cfg) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#owner, config::StakedBalanceContractName, vector<AccountName>{}, "CreateProducer", \
                          types::CreateProducer{#owner, key, cfg}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 #define MKPDCR3(chain, owner, key) MKPDCR4(chain, owner, key, BlockchainConfiguration{});
 #define MKPDCR2(chain, owner) \
    Make_Key(owner ## _producer); \
    MKPDCR4(chain, owner, owner ## _producer_public_key, BlockchainConfiguration{});
 
-#define APPDCR4(chain, voter, producer, approved) \
+#define APPDCR4(blockchain, voter, producer, approved) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(#voter, config::StakedBalanceContractName, vector<AccountName>{}, "ApproveProducer", \
                          types::ApproveProducer{#producer, approved? 1 : 0}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 
-#define UPPDCR4(chain, owner, key, cfg) \
+#define UPPDCR4(blockchain, owner, key, cfg) \
    { \
       eos::chain::SignedTransaction trx; \
       trx.emplaceMessage(owner, config::StakedBalanceContractName, vector<AccountName>{}, "UpdateProducer", \
                                 types::UpdateProducer{owner, key, cfg}); \
-      trx.expiration = chain.head_block_time() + 100; \
-      trx.set_reference_block(chain.head_block_id()); \
-      chain.push_transaction(trx); \
+      trx.expiration = blockchain.head_block_time() + 100; \
+      trx.set_reference_block(blockchain.head_block_id()); \
+      blockchain.push_transaction(trx); \
    }
 #define UPPDCR3(chain, owner, key) UPPDCR4(chain, owner, key, chain.get_producer(owner).configuration)
@@ -29,6 +29,9 @@
 #include <eos/chain/account_object.hpp>
 #include <eos/chain/key_value_object.hpp>
 #include <eos/chain/block_summary_object.hpp>
+#include <eos/chain/generated_transaction_object.hpp>
+
+#include <eos/native_contract/balance_object.hpp>
 
 #include <eos/utilities/tempdir.hpp>
 
@@ -110,6 +113,735 @@ BOOST_FIXTURE_TEST_CASE(order_dependent_transactions, testing_fixture)
       BOOST_CHECK_EQUAL(chain.get_liquid_balance("init0"), Asset(100000-99));
 } FC_LOG_AND_RETHROW() }
 
+// Test that pending transactions included in an incoming block are dropped, and the rest survive the block
+BOOST_FIXTURE_TEST_CASE(pending_state_rebuild, testing_fixture)
+{ try {
+      Make_Blockchains((chain1)(chain2));
+      chain1.produce_blocks(10);
+      chain1.sync_with(chain2);
+      BOOST_REQUIRE_EQUAL(chain2.head_block_num(), 10);
+
+      // Both chains get the same transfer; only chain1 gets the second one
+      Transfer_Asset(chain1, init0, init1, Asset(1));
+      Transfer_Asset(chain2, init0, init1, Asset(1));
+      Transfer_Asset(chain1, init2, init3, Asset(5));
+
+      chain2.produce_blocks();
+      chain1.push_block(*chain2.fetch_block_by_number(11));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init1"), Asset(100000 + 1));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init3"), Asset(100000 + 5));
+
+      chain1.produce_blocks();
+      BOOST_REQUIRE_EQUAL(chain1.head_block_num(), 12);
+      size_t count = 0;
+      for (const auto& cycle : chain1.fetch_block_by_number(12)->cycles)
+         for (const auto& thread : cycle)
+            count += thread.user_input.size();
+      BOOST_CHECK_EQUAL(count, 1);
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init0"), Asset(100000 - 1));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init1"), Asset(100000 + 1));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init2"), Asset(100000 - 5));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init3"), Asset(100000 + 5));
+} FC_LOG_AND_RETHROW() }
+
+// Test that a run of blocks pushed through the pipeline matches pushing them one at a time, and a bad block stops it
+BOOST_FIXTURE_TEST_CASE(pipelined_block_push, testing_fixture)
+{ try {
+      Make_Blockchains((chain1)(chain2));
+      chain1.produce_blocks(5);
+      Transfer_Asset(chain1, init0, init1, Asset(10));
+      chain1.produce_blocks(5);
+
+      vector<signed_block> blocks;
+      for (uint32_t i = 1; i <= chain1.head_block_num(); ++i)
+         blocks.emplace_back(*chain1.fetch_block_by_number(i));
+
+      auto checked = chain2.prevalidate_block(blocks.front()).get();
+      BOOST_CHECK(checked.id == blocks.front().id());
+      BOOST_REQUIRE(checked.merkle_root && checked.signee);
+      BOOST_CHECK(*checked.merkle_root == blocks.front().transaction_merkle_root);
+      BOOST_CHECK(*checked.signee == public_key_type(blocks.front().signee()));
+
+      auto results = chain2.push_blocks(blocks);
+      BOOST_CHECK_EQUAL(results.size(), blocks.size());
+      BOOST_CHECK_EQUAL(chain2.head_block_num(), 10);
+      BOOST_CHECK(chain2.head_block_id() == chain1.head_block_id());
+      BOOST_CHECK_EQUAL(chain2.get_liquid_balance("init1"), Asset(100000 + 10));
+
+      // A block signed by the wrong key is rejected, and the blocks after it are not applied
+      chain1.produce_blocks(3);
+      blocks.clear();
+      for (uint32_t i = 11; i <= chain1.head_block_num(); ++i)
+         blocks.emplace_back(*chain1.fetch_block_by_number(i));
+      blocks[1].sign(private_key_type::regenerate(fc::digest("not_a_producer")));
+      BOOST_CHECK_THROW(chain2.push_blocks(blocks), block_validate_exception);
+      BOOST_CHECK_EQUAL(chain2.head_block_num(), 11);
+} FC_LOG_AND_RETHROW() }
+
+// Test that applied transactions are deduplicated with or without their bodies stored, and forgotten once expired
+BOOST_FIXTURE_TEST_CASE(transaction_dedupe_storage, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+
+      auto make_transfer = [&chain](const AccountName& from, const AccountName& to) {
+         SignedTransaction trx;
+         trx.emplaceMessage(from, config::EosContractName, vector<AccountName>{to}, "Transfer",
+                            types::Transfer{from, to, Asset(1), ""});
+         trx.expiration = chain.head_block_time() + 100;
+         trx.set_reference_block(chain.head_block_id());
+         return trx;
+      };
+
+      auto stored = make_transfer("init0", "init1");
+      chain.push_transaction(stored);
+      chain.produce_blocks();
+      BOOST_CHECK(chain.is_known_transaction(stored.id()));
+      BOOST_CHECK(chain.get_recent_transaction(stored.id()).id() == stored.id());
+      BOOST_CHECK_THROW(chain.push_transaction(stored), transaction_exception);
+
+      chain.set_store_transaction_bodies(false);
+      auto unstored = make_transfer("init2", "init3");
+      chain.push_transaction(unstored);
+      chain.produce_blocks();
+      BOOST_CHECK(chain.is_known_transaction(unstored.id()));
+      BOOST_CHECK_THROW(chain.get_recent_transaction(unstored.id()), fc::exception);
+      BOOST_CHECK_THROW(chain.push_transaction(unstored), transaction_exception);
+
+      // Both expire at about the same time, and are dropped from the index together
+      chain.produce_blocks(40);
+      BOOST_CHECK(!chain.is_known_transaction(stored.id()));
+      BOOST_CHECK(!chain.is_known_transaction(unstored.id()));
+} FC_LOG_AND_RETHROW() }
+
+// Test that the candidate block follows the pending transactions, and is dropped when another block arrives
+BOOST_FIXTURE_TEST_CASE(candidate_block, testing_fixture)
+{ try {
+      Make_Blockchains((chain1)(chain2));
+      chain1.produce_blocks(10);
+      chain1.sync_with(chain2);
+      BOOST_CHECK(!chain1.candidate_block_ready());
+
+      Transfer_Asset(chain1, init0, init1, Asset(1));
+      Transfer_Asset(chain1, init2, init3, Asset(2));
+      BOOST_CHECK(chain1.candidate_block_ready());
+
+      chain1.produce_blocks();
+      BOOST_CHECK(!chain1.candidate_block_ready());
+      BOOST_CHECK_EQUAL(chain1.last_block_schedule_stats().transactions, 2);
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init1"), Asset(100000 + 1));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init3"), Asset(100000 + 2));
+
+      // A block arriving from elsewhere rebuilds the pending state, and the candidate along with it
+      chain1.sync_with(chain2);
+      Transfer_Asset(chain2, init0, init1, Asset(5));
+      chain2.produce_blocks();
+      Transfer_Asset(chain1, init2, init3, Asset(7));
+      chain1.push_block(*chain2.fetch_block_by_number(12));
+      BOOST_CHECK(chain1.candidate_block_ready());
+      chain1.produce_blocks();
+      BOOST_CHECK_EQUAL(chain1.last_block_schedule_stats().transactions, 1);
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init1"), Asset(100000 + 1 + 5));
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init3"), Asset(100000 + 2 + 7));
+} FC_LOG_AND_RETHROW() }
+
+// Test that transaction execution times are recorded, and that generated blocks keep to the execution budget
+BOOST_FIXTURE_TEST_CASE(block_execution_budget, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+
+      // Measured times depend on the machine, so every transaction is charged the same time instead
+      chain.set_cpu_time_charge([](fc::microseconds) { return fc::microseconds(100); });
+      Transfer_Asset(chain, init0, init1, Asset(1));
+      const auto& time = chain.recent_execution_times().back();
+      BOOST_CHECK_EQUAL(time.messages.size(), 1);
+      BOOST_CHECK(time.messages[0].type == types::TypeName("Transfer"));
+      BOOST_CHECK_EQUAL(time.cpu.count(), 100);
+      BOOST_CHECK(time.wall >= time.messages[0].wall);
+      chain.produce_blocks();
+      BOOST_CHECK_EQUAL(chain.last_block_schedule_stats().transactions, 1);
+
+      // With a budget for less than two transactions, each block takes a single transaction and postpones the others
+      chain.set_block_execution_budget(fc::microseconds(150));
+      Transfer_Asset(chain, init0, init1, Asset(2));
+      Transfer_Asset(chain, init2, init3, Asset(3));
+      Transfer_Asset(chain, init4, init5, Asset(4));
+      BOOST_CHECK(!chain.candidate_block_ready());
+      for (int i = 0; i < 3; ++i) {
+         chain.produce_blocks();
+         BOOST_CHECK_EQUAL(chain.last_block_schedule_stats().transactions, 1);
+      }
+      chain.produce_blocks();
+      BOOST_CHECK_EQUAL(chain.last_block_schedule_stats().transactions, 0);
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000 + 1 + 2));
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init3"), Asset(100000 + 3));
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init5"), Asset(100000 + 4));
+} FC_LOG_AND_RETHROW() }
+
+// Test that the published head block state follows the head block, and is left alone by pending transactions
+BOOST_FIXTURE_TEST_CASE(head_block_state, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      auto genesis = chain.get_head_block_state();
+      BOOST_CHECK_EQUAL(genesis->head_block_num, 0);
+
+      chain.produce_blocks(10);
+      auto head = chain.get_head_block_state();
+      BOOST_CHECK_EQUAL(head->head_block_num, 10);
+      BOOST_CHECK_EQUAL(head->head_block_id.str(), chain.head_block_id().str());
+      BOOST_CHECK(head->head_block_time == chain.head_block_time());
+      BOOST_CHECK(head->head_block_producer == chain.head_block_producer());
+      BOOST_CHECK_EQUAL(head->last_irreversible_block_num, chain.last_irreversible_block_num());
+      // States already handed out are not changed by later blocks
+      BOOST_CHECK_EQUAL(genesis->head_block_num, 0);
+
+      Transfer_Asset(chain, init0, init1, Asset(1));
+      BOOST_CHECK(chain.get_head_block_state() == head);
+
+      chain.pop_block();
+      BOOST_CHECK_EQUAL(chain.get_head_block_state()->head_block_num, 9);
+      BOOST_CHECK_EQUAL(chain.with_read_lock([&]() { return chain.head_block_num(); }), 9);
+} FC_LOG_AND_RETHROW() }
+
+// Test that reversible blocks are found by number on the current branch, through pops and fork switches
+BOOST_FIXTURE_TEST_CASE(fetch_reversible_block_by_number, testing_fixture)
+{ try {
+      Make_Blockchains((chain1)(chain2));
+      chain1.produce_blocks(10);
+      chain1.sync_with(chain2);
+
+      chain1.produce_blocks(1, 1);
+      chain2.produce_blocks(3);
+      BOOST_CHECK_NE(chain1.fetch_block_by_number(11)->id().str(), chain2.fetch_block_by_number(11)->id().str());
+
+      // chain2's branch is longer, so chain1 switches to it
+      chain1.sync_with(chain2);
+      BOOST_CHECK_EQUAL(chain1.head_block_num(), 13);
+      BOOST_CHECK_LT(chain1.last_irreversible_block_num(), 13);
+      for (uint32_t num = 1; num <= 13; ++num)
+         BOOST_CHECK_EQUAL(chain1.get_block_id_for_num(num).str(), chain2.get_block_id_for_num(num).str());
+
+      chain1.pop_block();
+      BOOST_CHECK(!chain1.fetch_block_by_number(13));
+      BOOST_CHECK_EQUAL(chain1.fetch_block_by_number(12)->id().str(), chain2.fetch_block_by_number(12)->id().str());
+      chain1.produce_blocks();
+      BOOST_CHECK_EQUAL(chain1.fetch_block_by_number(13)->id().str(), chain1.head_block_id().str());
+} FC_LOG_AND_RETHROW() }
+
+// Test that blocks which became irreversible can be fetched while they are still waiting to be written to the block log
+BOOST_FIXTURE_TEST_CASE(block_log_writer_behind, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      auto last_durable = chain.last_durable_block_num();
+
+      // produce_blocks waits for the writer, so the blocks are generated here
+      chain.get_block_log_writer().pause();
+      for (int i = 0; i < 30; ++i) {
+         auto producer = chain.get_producer(chain.get_scheduled_producer(1));
+         chain.generate_block(chain.get_slot_time(1), producer.owner, get_private_key(producer.signing_key), 0);
+      }
+      BOOST_REQUIRE_GT(chain.last_irreversible_block_num(), last_durable);
+      BOOST_CHECK_EQUAL(chain.last_durable_block_num(), last_durable);
+
+      for (uint32_t num = 1; num <= chain.head_block_num(); ++num) {
+         auto block = chain.fetch_block_by_number(num);
+         BOOST_REQUIRE(block);
+         BOOST_CHECK_EQUAL(block->block_num(), num);
+         BOOST_CHECK(chain.get_block_id_for_num(num) == block->id());
+      }
+
+      chain.get_block_log_writer().resume();
+      chain.flush_block_log();
+      BOOST_CHECK_EQUAL(chain.last_durable_block_num(), chain.last_irreversible_block_num());
+      BOOST_CHECK(chain.fetch_block_by_number(chain.last_irreversible_block_num()));
+} FC_LOG_AND_RETHROW() }
+
+// Test that irreversible blocks reach the block log in the background, and that a database left behind the block log
+// catches up by replaying the blocks it is missing
+BOOST_FIXTURE_TEST_CASE(block_log_writer, testing_fixture)
+{ try {
+      uint32_t first_irreversible, log_head;
+      {
+         chainbase::database db(get_temp_dir("behind"), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+         chain.set_block_log_sync_interval(7);
+
+         chain.produce_blocks(30);
+         first_irreversible = chain.last_irreversible_block_num();
+         BOOST_CHECK_GT(first_irreversible, 0);
+         BOOST_CHECK_EQUAL(chain.last_durable_block_num(), first_irreversible);
+         BOOST_CHECK_EQUAL(log.head()->block_num(), first_irreversible);
+         BOOST_CHECK(log.head()->id() == chain.get_block_id_for_num(first_irreversible));
+      }
+
+      {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+
+         BOOST_CHECK_EQUAL(chain.head_block_num(), first_irreversible);
+         chain.produce_blocks(30);
+         log_head = chain.last_irreversible_block_num();
+         BOOST_CHECK_GT(log_head, first_irreversible);
+         BOOST_CHECK_EQUAL(chain.last_durable_block_num(), log_head);
+      }
+
+      {
+         chainbase::database db(get_temp_dir("behind"), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+
+         BOOST_CHECK_EQUAL(chain.head_block_num(), log_head);
+         BOOST_CHECK(chain.head_block_id() == log.head()->id());
+         chain.produce_blocks();
+         BOOST_CHECK_EQUAL(chain.head_block_num(), log_head + 1);
+      }
+} FC_LOG_AND_RETHROW() }
+
+// Test that declared authorizations must be satisfied by the transaction's signatures
+BOOST_FIXTURE_TEST_CASE(authority_check, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      Make_Key(alice_owner);
+      Make_Key(alice_active);
+      Make_Key(stranger);
+
+      auto create_account = [&chain](AccountName name, Authority owner, Authority active) {
+         SignedTransaction trx;
+         trx.emplaceMessage("init0", config::SystemContractName,
+                            vector<AccountName>{config::StakedBalanceContractName, config::EosContractName},
+                            "CreateAccount",
+                            types::CreateAccount{"init0", name, owner, active, Account_Authority(init0), Asset(100)});
+         trx.expiration = chain.head_block_time() + 100;
+         trx.set_reference_block(chain.head_block_id());
+         chain.push_transaction(trx);
+      };
+      create_account("alice", Key_Authority(alice_owner_public_key), Key_Authority(alice_active_public_key));
+      create_account("bob", Account_Authority(alice), Account_Authority(alice));
+      chain.produce_blocks();
+      chain.set_authority_checking(true);
+
+      // Each transfer moves a different amount, so that no two transactions share an ID
+      uint64_t amount = 0;
+      auto transfer_declaring = [&](AccountName from, vector<types::AccountPermission> declared,
+                                    vector<private_key_type> keys) {
+         SignedTransaction trx;
+         trx.emplaceMessage(from, config::EosContractName, vector<AccountName>{"init1"}, "Transfer",
+                            types::Transfer{from, "init1", Asset(++amount), ""});
+         trx.authorizations = std::move(declared);
+         trx.expiration = chain.head_block_time() + 100;
+         trx.set_reference_block(chain.head_block_id());
+         for (const auto& key : keys)
+            trx.sign(key, chain.get_chain_id());
+         chain.push_transaction(trx);
+      };
+      auto transfer = [&](AccountName from, PermissionName permission, vector<private_key_type> keys) {
+         transfer_declaring(from, {{from, permission}}, std::move(keys));
+      };
+
+      BOOST_CHECK_THROW(transfer("alice", "active", {}), tx_missing_active_auth);
+      BOOST_CHECK_THROW(transfer("alice", "active", {stranger_private_key}), tx_missing_active_auth);
+      BOOST_CHECK_THROW(transfer("alice", "owner", {alice_active_private_key}), tx_missing_owner_auth);
+      BOOST_CHECK_THROW(transfer("alice", "recovery", {alice_owner_private_key}), tx_missing_other_auth);
+      // Every sender must be covered by a declared authorization, even when the declared ones are satisfied
+      BOOST_CHECK_THROW(transfer_declaring("alice", {}, {alice_active_private_key}), tx_missing_active_auth);
+      BOOST_CHECK_THROW(transfer_declaring("alice", {{"bob", "active"}}, {alice_active_private_key}),
+                        tx_missing_active_auth);
+      transfer("alice", "active", {alice_active_private_key});
+      transfer("alice", "owner", {alice_owner_private_key});
+      // The owner permission is the parent of the active one, so it may do whatever the active one may
+      transfer("alice", "active", {alice_owner_private_key});
+
+      // Bob's permissions are satisfied by alice's active permission, and so by either of alice's keys
+      transfer("bob", "active", {alice_active_private_key});
+      transfer("bob", "owner", {alice_owner_private_key});
+      BOOST_CHECK_THROW(transfer("bob", "owner", {stranger_private_key}), tx_missing_owner_auth);
+      BOOST_CHECK_GT(chain.get_permission_cache().hits(), 0);
+
+      // The block producer checks the authorizations again, as does every node applying the block
+      chain.produce_blocks();
+      BOOST_REQUIRE_EQUAL(chain.head_block_num(), 12);
+      size_t count = 0;
+      for (const auto& cycle : chain.fetch_block_by_number(12)->cycles)
+         for (const auto& thread : cycle)
+            count += thread.user_input.size();
+      BOOST_CHECK_EQUAL(count, 5);
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Create an account for each of accounts, paired with its active authority. The owners are init0's active authority,
+ * which the tests do not sign for, so that each active permission is only satisfied by its own authority.
+ */
+void create_accounts(testing_blockchain& chain, const vector<std::pair<AccountName, Authority>>& accounts) {
+   for (const auto& account : accounts) {
+      SignedTransaction trx;
+      trx.emplaceMessage("init0", config::SystemContractName,
+                         vector<AccountName>{config::StakedBalanceContractName, config::EosContractName},
+                         "CreateAccount",
+                         types::CreateAccount{"init0", account.first, Account_Authority(init0), account.second,
+                                              Account_Authority(init0), Asset(100)});
+      trx.expiration = chain.head_block_time() + 100;
+      trx.set_reference_block(chain.head_block_id());
+      chain.push_transaction(trx);
+   }
+   chain.produce_blocks();
+}
+
+/// Push a transfer from the first declared account, declaring the active permission of each of declared
+void push_transfer_declaring(testing_blockchain& chain, vector<AccountName> declared, const private_key_type& key) {
+   SignedTransaction trx;
+   trx.emplaceMessage(declared.front(), config::EosContractName, vector<AccountName>{"init1"}, "Transfer",
+                      types::Transfer{declared.front(), "init1", Asset(1), ""});
+   for (const auto& account : declared)
+      trx.authorizations.push_back({account, "active"});
+   trx.expiration = chain.head_block_time() + 100;
+   trx.set_reference_block(chain.head_block_id());
+   trx.sign(key, chain.get_chain_id());
+   chain.push_transaction(trx);
+}
+
+// Test that a permission found unsatisfied only because it was reached through a cycle is still checked on its own
+BOOST_FIXTURE_TEST_CASE(authority_check_cycle, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      Make_Key(carol);
+
+      // cyclec needs cycleb or cyclea; cycleb needs cyclec, which cyclea's key satisfies. cycleb is listed first, so
+      // checking cyclec reaches cyclec again through cycleb before trying cyclea.
+      create_accounts(chain, {
+         {"cyclea", Key_Authority(carol_public_key)},
+         {"cycleb", Account_Authority(cyclec)},
+         {"cyclec", Authority{1, {}, {{{"cycleb", "active"}, 1}, {{"cyclea", "active"}, 1}}}}
+      });
+      chain.set_authority_checking(true);
+
+      push_transfer_declaring(chain, {"cycleb"}, carol_private_key);
+      push_transfer_declaring(chain, {"cyclec", "cycleb"}, carol_private_key);
+      chain.produce_blocks();
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000 + 2));
+} FC_LOG_AND_RETHROW() }
+
+// Test that a permission found unsatisfied only because it was nested too deep is still checked at a shallower depth
+BOOST_FIXTURE_TEST_CASE(authority_check_depth, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      Make_Key(dave);
+      static_assert(config::MaxAuthorityDepth == 6, "the chain below must reach depthb at the maximum depth");
+
+      // depthh reaches depthb through five permissions, at the maximum depth, where depthb's own accounts are not
+      // checked. depthh is satisfied through deptha instead, and depthb, declared itself, is satisfied through deptha.
+      create_accounts(chain, {
+         {"deptha", Key_Authority(dave_public_key)},
+         {"depthb", Account_Authority(deptha)},
+         {"depthc", Account_Authority(depthb)},
+         {"depthd", Account_Authority(depthc)},
+         {"depthe", Account_Authority(depthd)},
+         {"depthf", Account_Authority(depthe)},
+         {"depthg", Account_Authority(depthf)},
+         {"depthh", Authority{1, {}, {{{"depthg", "active"}, 1}, {{"deptha", "active"}, 1}}}}
+      });
+      chain.set_authority_checking(true);
+
+      push_transfer_declaring(chain, {"depthh", "depthb"}, dave_private_key);
+      chain.produce_blocks();
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000 + 1));
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Registers native handlers standing in for a contract which sends a transfer from init0 to init1 when init0 is pinged,
+ * and for contracts which try to generate transactions they may not: a transfer sent by init1 (Forge), one declaring the
+ * authority of init1 (ForgeAuthority), and one of a negative amount (Negative). The chain_controller freezes its
+ * handler table once constructed, so the handlers are installed by the initializer.
+ */
+class ping_chain_initializer : public native_contract::native_contract_chain_initializer {
+public:
+   using native_contract::native_contract_chain_initializer::native_contract_chain_initializer;
+
+   void register_types(chain_controller& chain, chainbase::database& db) override {
+      native_contract_chain_initializer::register_types(chain, db);
+      auto generate_transfer = [&chain](const AccountName& sender, const AccountName& from, const AccountName& to,
+                                        Asset amount, vector<types::AccountPermission> authorization) {
+         return [&chain, sender, from, to, amount, authorization](apply_context& context) {
+            generated_transaction trx;
+            trx.expiration = chain.head_block_time() + 100;
+            trx.authorization = authorization;
+            trx.messages.emplace_back(sender, config::EosContractName, vector<AccountName>{to}, "Transfer",
+                                      fc::raw::pack(types::Transfer{from, to, amount, ""}));
+            context.generated.emplace_back(std::move(trx));
+         };
+      };
+      chain.set_apply_handler("init0", "init0", "Ping", generate_transfer("init0", "init0", "init1", Asset(1), {}));
+      chain.set_apply_handler("init0", "init0", "Forge", generate_transfer("init1", "init1", "init0", Asset(1), {}));
+      chain.set_apply_handler("init0", "init0", "ForgeAuthority",
+                              generate_transfer("init0", "init1", "init0", Asset(1), {{"init1", "active"}}));
+      chain.set_apply_handler("init0", "init0", "Negative", generate_transfer("init0", "init0", "init1", Asset(-1), {}));
+   }
+};
+
+/// Like Make_Blockchain, but the chain's initializer is a ping_chain_initializer
+#define Make_Ping_Blockchain(name) \
+   chainbase::database name ## _db(get_temp_dir(#name), chainbase::database::read_write, TEST_DB_SIZE); \
+   block_log name ## _log(get_temp_dir(#name) / "blocklog"); \
+   fork_database name ## _fdb; \
+   ping_chain_initializer name ## _initializer(genesis_state()); \
+   testing_blockchain name(name ## _db, name ## _fdb, name ## _log, name ## _initializer, *this);
+
+/// Push a transaction pinging init0, so that applying it generates a transfer; type selects the handler pinged
+void push_ping(testing_blockchain& chain, uint32_t lifetime = 100, const TypeName& type = "Ping") {
+   SignedTransaction trx;
+   trx.messages.emplace_back("init0", "init0", vector<AccountName>{}, type, Bytes{});
+   trx.expiration = chain.head_block_time() + lifetime;
+   trx.set_reference_block(chain.head_block_id());
+   chain.push_transaction(trx);
+}
+
+// Test that transactions generated by a contract are queued, included in the next block, and applied once
+BOOST_FIXTURE_TEST_CASE(generated_transactions, testing_fixture)
+{ try {
+      Make_Ping_Blockchain(chain1)
+      Make_Ping_Blockchain(chain2)
+      Make_Network(net, (chain1)(chain2))
+      chain1.produce_blocks(10);
+
+      push_ping(chain1);
+
+      // The block applying the ping queues the transfer, without applying it
+      chain1.produce_blocks();
+      BOOST_CHECK(chain1.fetch_block_by_number(11)->cycles.front().front().generated_input.empty());
+      BOOST_CHECK_EQUAL(chain2.get_liquid_balance("init1"), Asset(100000));
+
+      // The next block includes it by ID, and every node dequeues and applies it
+      chain1.produce_blocks();
+      auto block = chain1.fetch_block_by_number(12);
+      BOOST_REQUIRE_EQUAL(block->cycles.size(), 1);
+      BOOST_REQUIRE_EQUAL(block->cycles.front().size(), 1);
+      BOOST_CHECK_EQUAL(block->cycles.front().front().generated_input.size(), 1);
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init1"), Asset(100000 + 1));
+      BOOST_CHECK_EQUAL(chain2.get_liquid_balance("init1"), Asset(100000 + 1));
+
+      chain2.produce_blocks();
+      BOOST_CHECK(chain2.fetch_block_by_number(13)->cycles.empty());
+      BOOST_CHECK_EQUAL(chain1.get_liquid_balance("init1"), Asset(100000 + 1));
+} FC_LOG_AND_RETHROW() }
+
+// Test that a contract may only generate transactions which speak for itself and whose messages validate
+BOOST_FIXTURE_TEST_CASE(generated_transactions_validated, testing_fixture)
+{ try {
+      Make_Ping_Blockchain(chain);
+      chain.produce_blocks(10);
+
+      // The message generating the transaction fails, and the transaction pinging the contract is rejected with it
+      BOOST_CHECK_THROW(push_ping(chain, 100, "Forge"), tx_missing_active_auth);
+      BOOST_CHECK_THROW(push_ping(chain, 100, "ForgeAuthority"), tx_missing_other_auth);
+      BOOST_CHECK_THROW(push_ping(chain, 100, "Negative"), message_validate_exception);
+      const auto& queued = chain_db.get_index<generated_transaction_multi_index, by_id>();
+      BOOST_CHECK(queued.empty());
+
+      chain.produce_blocks(2);
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init0"), Asset(100000));
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000));
+
+      // A transaction the contract may generate is still queued and applied
+      push_ping(chain);
+      chain.produce_blocks(2);
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000 + 1));
+} FC_LOG_AND_RETHROW() }
+
+// Test that a block whose cycle contains threads with overlapping scopes is rejected
+BOOST_FIXTURE_TEST_CASE(conflicting_threads_in_cycle, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+
+      auto make_transfer = [&chain](const AccountName& from, const AccountName& to) {
+         SignedTransaction trx;
+         trx.emplaceMessage(from, config::EosContractName, vector<AccountName>{to}, "Transfer",
+                            types::Transfer{from, to, Asset(1), ""});
+         trx.expiration = chain.head_block_time() + 100;
+         trx.set_reference_block(chain.head_block_id());
+         return trx;
+      };
+
+      BOOST_CHECK(make_transfer("init0", "init1").read_scope() == flat_set<AccountName>{"init0"});
+      BOOST_CHECK((make_transfer("init0", "init1").write_scope() ==
+                   flat_set<AccountName>{config::EosContractName, "init1"}));
+
+      auto producer = chain.get_producer(chain.get_scheduled_producer(1));
+      signed_block block;
+      block.previous = chain.head_block_id();
+      block.timestamp = chain.get_slot_time(1);
+      block.producer = producer.owner;
+      block.cycles.resize(1);
+      block.cycles.front().resize(2);
+      // Both transfers write the eos contract's scope, so they may not run in separate threads of one cycle
+      block.cycles.front()[0].user_input.emplace_back(make_transfer("init0", "init1"));
+      block.cycles.front()[1].user_input.emplace_back(make_transfer("init2", "init3"));
+      block.transaction_merkle_root = block.calculate_merkle_root();
+      block.sign(get_private_key(producer.signing_key));
+
+      BOOST_CHECK_THROW(chain.push_block(block), block_concurrency_exception);
+      BOOST_CHECK_EQUAL(chain.head_block_num(), 10);
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init0"), Asset(100000));
+} FC_LOG_AND_RETHROW() }
+
+// Test that the scopes of generated transactions are also checked for conflicts between the threads of a cycle
+BOOST_FIXTURE_TEST_CASE(conflicting_generated_threads_in_cycle, testing_fixture)
+{ try {
+      Make_Ping_Blockchain(chain);
+      chain.produce_blocks(10);
+
+      // Queue two generated transfers, both of which write the eos contract's scope
+      push_ping(chain, 100);
+      push_ping(chain, 101);
+      chain.produce_blocks();
+      vector<generated_transaction_id_type> ids;
+      for (const auto& queued : chain_db.get_index<generated_transaction_multi_index, by_id>())
+         ids.push_back(queued.trx_id);
+      BOOST_REQUIRE_EQUAL(ids.size(), 2);
+
+      auto producer = chain.get_producer(chain.get_scheduled_producer(1));
+      signed_block block;
+      block.previous = chain.head_block_id();
+      block.timestamp = chain.get_slot_time(1);
+      block.producer = producer.owner;
+      block.cycles.resize(1);
+      block.cycles.front().resize(2);
+      block.cycles.front()[0].generated_input.push_back(ids[0]);
+      block.cycles.front()[1].generated_input.push_back(ids[1]);
+      block.transaction_merkle_root = block.calculate_merkle_root();
+      block.sign(get_private_key(producer.signing_key));
+
+      BOOST_CHECK_THROW(chain.push_block(block), block_concurrency_exception);
+      BOOST_CHECK_EQUAL(chain.head_block_num(), 11);
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000));
+} FC_LOG_AND_RETHROW() }
+
+// Test that the scheduler packs non-conflicting transactions into separate threads and opens a new cycle when needed
+BOOST_AUTO_TEST_CASE(transaction_scheduling)
+{ try {
+      auto make_trx = [](vector<Message> messages) {
+         SignedTransaction trx;
+         for (auto& m : messages)
+            trx.messages.emplace_back(m);
+         return trx;
+      };
+      auto transfer = [](const AccountName& from, const AccountName& to) {
+         return Message(from, config::EosContractName, vector<AccountName>{to}, "Transfer",
+                        types::Transfer{from, to, Asset(1), ""});
+      };
+      auto unlock = [](const AccountName& account) {
+         return Message(account, config::StakedBalanceContractName, vector<AccountName>{}, "StartUnlockEos",
+                        types::StartUnlockEos{account, 1});
+      };
+
+      vector<cycle> cycles;
+      transaction_scheduler scheduler(cycles, 4);
+      scheduler.schedule(make_trx({transfer("init0", "init1")}));
+      scheduler.schedule(make_trx({unlock("init2")}));
+      scheduler.schedule(make_trx({transfer("init3", "init4")}));
+      scheduler.schedule(make_trx({transfer("init5", "init6"), unlock("init7")}));
+
+      BOOST_REQUIRE_EQUAL(cycles.size(), 2);
+      BOOST_REQUIRE_EQUAL(cycles[0].size(), 2);
+      BOOST_CHECK_EQUAL(cycles[0][0].user_input.size(), 2);
+      BOOST_CHECK_EQUAL(cycles[0][1].user_input.size(), 1);
+      BOOST_REQUIRE_EQUAL(cycles[1].size(), 1);
+      BOOST_CHECK_EQUAL(cycles[1][0].user_input.size(), 1);
+
+      auto stats = scheduler.stats();
+      BOOST_CHECK_EQUAL(stats.transactions, 4);
+      BOOST_CHECK_EQUAL(stats.cycles, 2);
+      BOOST_CHECK_EQUAL(stats.threads, 3);
+      BOOST_CHECK_EQUAL(stats.max_threads_per_cycle, 2);
+      BOOST_CHECK_EQUAL(stats.critical_path, 3);
+} FC_LOG_AND_RETHROW() }
+
+// Test that the values cached by transaction_metadata match those computed from the transaction
+BOOST_AUTO_TEST_CASE(transaction_metadata_values)
+{ try {
+      SignedTransaction trx;
+      trx.emplaceMessage("init0", config::EosContractName, vector<AccountName>{"init1"}, "Transfer",
+                         types::Transfer{"init0", "init1", Asset(1), "memo"});
+      trx.expiration = fc::time_point_sec(1000);
+      auto key = private_key_type::regenerate(fc::digest("metadata_key"));
+      chain_id_type chain_id = fc::sha256::hash(std::string("chain"));
+      trx.sign(key, chain_id);
+
+      transaction_metadata meta(trx);
+      BOOST_CHECK_EQUAL(meta.id().str(), trx.id().str());
+      BOOST_CHECK_EQUAL(meta.digest().str(), trx.digest().str());
+      BOOST_CHECK_EQUAL(meta.sig_digest(chain_id).str(), trx.sig_digest(chain_id).str());
+      BOOST_CHECK_EQUAL(meta.packed_size(), fc::raw::pack_size(trx));
+      BOOST_CHECK(meta.packed() == fc::raw::pack(trx));
+} FC_LOG_AND_RETHROW() }
+
+// Test that signatures are recovered and that a repeated signature is rejected
+BOOST_FIXTURE_TEST_CASE(transaction_signature_recovery, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      Make_Key(signer);
+
+      SignedTransaction trx;
+      trx.emplaceMessage("init0", config::EosContractName, vector<AccountName>{"init1"}, "Transfer",
+                         types::Transfer{"init0", "init1", Asset(1), ""});
+      trx.expiration = chain.head_block_time() + 100;
+      trx.set_reference_block(chain.head_block_id());
+      trx.sign(signer_private_key, chain.get_chain_id());
+      BOOST_CHECK(trx.get_signature_keys(chain.get_chain_id()) == flat_set<public_key_type>{signer_public_key});
+
+      const auto& cache = chain.get_recovered_key_cache();
+      auto misses = cache.misses();
+      auto duplicate = trx;
+      duplicate.signatures.push_back(duplicate.signatures.front());
+      BOOST_CHECK_THROW(chain.push_transaction(duplicate), tx_duplicate_sig);
+      BOOST_CHECK_EQUAL(cache.misses(), misses + 1);
+
+      chain.push_transaction(trx);
+      BOOST_CHECK_EQUAL(cache.misses(), misses + 1);
+
+      // Generating and applying the block validates the transaction again, without recovering its key again
+      auto hits = cache.hits();
+      chain.produce_blocks();
+      BOOST_CHECK_EQUAL(cache.misses(), misses + 1);
+      BOOST_CHECK_GT(cache.hits(), hits);
+      BOOST_CHECK_EQUAL(chain.fetch_block_by_number(11)->cycles.front().front().user_input.size(), 1);
+      BOOST_CHECK_EQUAL(chain.get_liquid_balance("init1"), Asset(100000 + 1));
+} FC_LOG_AND_RETHROW() }
+
+// Test that the recovered key cache evicts the least recently used key
+BOOST_FIXTURE_TEST_CASE(recovered_key_cache_eviction, testing_fixture)
+{ try {
+      Make_Key(signer);
+      auto first = fc::sha256::hash(std::string("first"));
+      auto second = fc::sha256::hash(std::string("second"));
+      auto first_sig = signer_private_key.sign_compact(first);
+      auto second_sig = signer_private_key.sign_compact(second);
+
+      recovered_key_cache cache(1);
+      BOOST_CHECK(cache.recover(first, first_sig) == signer_public_key);
+      BOOST_CHECK(cache.recover(first, first_sig) == signer_public_key);
+      BOOST_CHECK_EQUAL(cache.hits(), 1);
+      BOOST_CHECK_EQUAL(cache.misses(), 1);
+
+      BOOST_CHECK(cache.recover(second, second_sig) == signer_public_key);
+      BOOST_CHECK_EQUAL(cache.size(), 1);
+      cache.recover(first, first_sig);
+      BOOST_CHECK_EQUAL(cache.hits(), 1);
+      BOOST_CHECK_EQUAL(cache.misses(), 3);
+} FC_LOG_AND_RETHROW() }
 
 vector<uint8_t> assemble_wast( const std::string& wast ) {
    std::cout << "\n" << wast << "\n";
@@ -1239,6 +1971,57 @@ BOOST_FIXTURE_TEST_CASE(reindex, testing_fixture)
       }
 } FC_LOG_AND_RETHROW() }
 
+// Test replaying a block log with checkpoints, and reading the log sequentially
+BOOST_FIXTURE_TEST_CASE(replay_with_checkpoints, testing_fixture)
+{ try {
+      auto lag = EOS_PERCENT(config::BlocksPerRound, config::IrreversibleThresholdPercent);
+      block_id_type checkpoint_id;
+      {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+
+         chain.produce_blocks(10);
+         Transfer_Asset(chain, init0, init1, Asset(10));
+         chain.produce_blocks(90);
+         checkpoint_id = chain.get_block_id_for_num(50);
+
+         auto reader = log.read_blocks_from(1);
+         uint32_t count = 0;
+         while (auto block = reader.next()) {
+            ++count;
+            BOOST_CHECK(block->id() == chain.get_block_id_for_num(count));
+         }
+         BOOST_CHECK_EQUAL(count, 100 - lag);
+         BOOST_CHECK(!log.read_blocks_from(101 - lag).next());
+      }
+
+      {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         chain_controller chain(db, fdb, log, initr, native_contract::make_administrator(), {{50, checkpoint_id}});
+
+         BOOST_CHECK_EQUAL(chain.head_block_num(), 100 - lag);
+         BOOST_CHECK(chain.get_block_id_for_num(50) == checkpoint_id);
+         BOOST_CHECK_EQUAL((db.get<BalanceObject, byOwnerName>("init1").balance), Asset(100000 + 10));
+      }
+
+      {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         // Block 51 does not match the checkpoint, so the replay must fail
+         BOOST_CHECK_THROW(chain_controller(db, fdb, log, initr, native_contract::make_administrator(),
+                                            {{51, checkpoint_id}}),
+                           fc::exception);
+      }
+} FC_LOG_AND_RETHROW() }
+
 // Test wiping a database and resyncing with an ongoing network
 BOOST_FIXTURE_TEST_CASE(wipe, testing_fixture)
 { try {
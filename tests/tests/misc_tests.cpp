@@ -1,5 +1,9 @@
 #include <eos/chain/BlockchainConfiguration.hpp>
+#include <eos/chain/message_handling_contexts.hpp>
+#include <eos/chain/message_handler_table.hpp>
+#include <eos/chain/transaction_id_filter.hpp>
 
+#include <eos/utilities/metrics.hpp>
 #include <eos/utilities/randutils.hpp>
 #include <eos/utilities/pcg-random/pcg_random.hpp>
 
@@ -7,6 +11,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+
 namespace eos {
 using namespace chain;
 
@@ -85,6 +91,125 @@ BOOST_AUTO_TEST_CASE(deterministic_distributions)
    BOOST_CHECK_EQUAL(rng.uniform(0, 9), 0);
 } FC_LOG_AND_RETHROW() }
 
+/// Test that contexts sharing a payload cache decode the message's data once
+BOOST_AUTO_TEST_CASE(message_payload_cache_shared)
+{ try {
+   Message m("inita", "eos", {"initb"}, "Transfer", types::Transfer{"inita", "initb", 100, ""});
+   auto payload = std::make_shared<message_payload_cache>();
+
+   const auto& first = payload->get<types::Transfer>(m);
+   BOOST_CHECK_EQUAL(first.amount, 100);
+   BOOST_CHECK_EQUAL(&payload->get<types::Transfer>(m), &first);
+
+   // Changing the data afterwards does not change the cached value
+   m.set("Transfer", types::Transfer{"inita", "initb", 5, ""});
+   BOOST_CHECK_EQUAL(payload->get<types::Transfer>(m).amount, 100);
+
+   // A different type is decoded separately, leaving the first value in place
+   const auto& from = payload->get<types::AccountName>(m);
+   BOOST_CHECK_EQUAL(from, "inita");
+   BOOST_CHECK_EQUAL(&payload->get<types::Transfer>(m), &first);
+} FC_LOG_AND_RETHROW() }
+
+/// Test lookups in the native message handler table before and after it is frozen
+BOOST_AUTO_TEST_CASE(message_handler_table_lookup)
+{ try {
+   message_handler_table table;
+   for (int i = 0; i < 100; ++i)
+      table.at("eos", "eos", "Type" + std::to_string(i)).apply = [](apply_context&) {};
+   table.at("eos", "staked", "Type7").precondition = [](precondition_validate_context&) {};
+   BOOST_CHECK_EQUAL(table.size(), 101);
+   BOOST_CHECK(table.find("eos", "eos", "Type7") == nullptr);
+
+   table.freeze();
+   BOOST_CHECK_THROW(table.at("eos", "eos", "Type100"), fc::exception);
+
+   for (int i = 0; i < 100; ++i) {
+      auto handlers = table.find("eos", "eos", "Type" + std::to_string(i));
+      BOOST_REQUIRE(handlers != nullptr);
+      BOOST_CHECK(!handlers->validate && !handlers->precondition);
+      BOOST_REQUIRE(handlers->apply);
+   }
+   BOOST_CHECK(table.find("eos", "eos", "Type100") == nullptr);
+   BOOST_CHECK(table.find("stake", "eos", "Type7") == nullptr);
+
+   auto notify = table.find("eos", "staked", "Type7");
+   BOOST_REQUIRE(notify != nullptr);
+   BOOST_CHECK(notify->precondition && !notify->apply);
+} FC_LOG_AND_RETHROW() }
+
+/// Test that the transaction ID filter has no false negatives, few false positives, and drops whole windows
+BOOST_AUTO_TEST_CASE(transaction_id_filter_windows)
+{ try {
+   transaction_id_filter filter(60, 1000, 0.001);
+   auto id = [](int i) { return transaction_id_type::hash(std::to_string(i)); };
+
+   for (int i = 0; i < 1000; ++i)
+      filter.insert(id(i), time_point_sec(i < 500? 30 : 90));
+   BOOST_CHECK_EQUAL(filter.window_count(), 2);
+   BOOST_CHECK(filter.earliest_window_end() == time_point_sec(60));
+
+   for (int i = 0; i < 1000; ++i)
+      BOOST_CHECK(filter.may_contain(id(i)));
+   int false_positives = 0;
+   for (int i = 1000; i < 11000; ++i)
+      false_positives += filter.may_contain(id(i));
+   BOOST_CHECK_LT(false_positives, 100);
+
+   filter.expire(time_point_sec(59));
+   BOOST_CHECK_EQUAL(filter.window_count(), 2);
+   filter.expire(time_point_sec(60));
+   BOOST_CHECK_EQUAL(filter.window_count(), 1);
+   for (int i = 500; i < 1000; ++i)
+      BOOST_CHECK(filter.may_contain(id(i)));
+
+   filter.expire(time_point_sec(1000));
+   BOOST_CHECK_EQUAL(filter.window_count(), 0);
+   BOOST_CHECK(!filter.may_contain(id(700)));
+} FC_LOG_AND_RETHROW() }
+
+/// Test that histograms bound the error of their quantiles, and that metrics merge the updates of every thread
+BOOST_AUTO_TEST_CASE(metrics_histogram_quantiles)
+{ try {
+   using utilities::histogram;
+   for (uint64_t v : {0ull, 7ull, 8ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull}) {
+      auto bucket = histogram::bucket_of(v);
+      BOOST_CHECK_GE(histogram::bucket_upper_bound(bucket), v);
+      BOOST_CHECK_LE(histogram::bucket_upper_bound(bucket) - v, v / histogram::sub_buckets);
+      if (bucket > 0)
+         BOOST_CHECK_LT(histogram::bucket_upper_bound(bucket - 1), v);
+   }
+   BOOST_CHECK_EQUAL(histogram::bucket_of(uint64_t(1) << 40), histogram::bucket_count - 1);
+
+   auto& registry = utilities::metrics_registry::get();
+   auto& h = registry.get_histogram("test_latency_us", "Test latencies");
+   auto& c = registry.get_counter("test_events_total", "Test events");
+   BOOST_CHECK_EQUAL(&h, &registry.get_histogram("test_latency_us", "Test latencies"));
+
+   vector<std::thread> threads;
+   for (int t = 0; t < 4; ++t)
+      threads.emplace_back([&h, &c] {
+         for (uint64_t v = 1; v <= 1000; ++v) {
+            h.record(v);
+            c.add();
+         }
+      });
+   for (auto& t : threads)
+      t.join();
+
+   auto values = h.read();
+   BOOST_CHECK_EQUAL(values.count, 4000);
+   BOOST_CHECK_EQUAL(values.sum, 4 * 500500);
+   BOOST_CHECK_EQUAL(c.value(), 4000);
+   auto median = values.quantile(0.5);
+   BOOST_CHECK_GE(median, 500);
+   BOOST_CHECK_LE(median, 500 + 500 / histogram::sub_buckets);
+
+   auto text = registry.prometheus_text();
+   BOOST_CHECK(text.find("# TYPE test_events_total counter\ntest_events_total 4000\n") != string::npos);
+   BOOST_CHECK(text.find("test_latency_us_count 4000\n") != string::npos);
+   BOOST_CHECK(text.find("test_latency_us{quantile=\"0.5\"} " + std::to_string(median) + "\n") != string::npos);
+} FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,257 @@
+#include <eos/chain/wasm_interface.hpp>
+
+#include <WAST/WAST.h>
+#include <Runtime/Runtime.h>
+#include <Runtime/Linker.h>
+#include <IR/Module.h>
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace eos::chain;
+
+namespace {
+
+IR::Module parse_wast( const std::string& wast ) {
+   IR::Module module;
+   std::vector<WAST::Error> parse_errors;
+   WAST::parseModule( wast.c_str(), wast.size(), module, parse_errors );
+   for( const auto& error : parse_errors )
+      BOOST_TEST_MESSAGE( error.locus.describe() << ": " << error.message );
+   FC_ASSERT( parse_errors.empty(), "error parsing wast" );
+   return module;
+}
+
+/// Keeps object code in memory, counting how often it was found and how often it was stored
+struct counting_object_cache : public Runtime::ObjectCache {
+   bool load( const std::string& key, std::vector<U8>& object_code ) override {
+      std::lock_guard<std::mutex> lock( mutex );
+      auto itr = objects.find( key );
+      if( itr == objects.end() ) return false;
+      object_code = itr->second;
+      ++hits;
+      return true;
+   }
+
+   void store( const std::string& key, const std::vector<U8>& object_code ) override {
+      std::lock_guard<std::mutex> lock( mutex );
+      objects[key] = object_code;
+      ++stores;
+   }
+
+   std::mutex                                  mutex;
+   std::map<std::string, std::vector<U8>>      objects;
+   uint32_t                                    hits   = 0;
+   uint32_t                                    stores = 0;
+};
+
+Runtime::ModuleInstance* instantiate( const IR::Module& module, Runtime::ObjectCache* cache = nullptr,
+                                      const std::string& key = std::string() ) {
+   Runtime::NullResolver resolver;
+   auto link_result = Runtime::linkModule( module, resolver );
+   FC_ASSERT( link_result.success );
+   auto instance = cache ? Runtime::instantiateModule( module, std::move(link_result.resolvedImports), cache, key )
+                         : Runtime::instantiateModule( module, std::move(link_result.resolvedImports) );
+   FC_ASSERT( instance );
+   return instance;
+}
+
+I32 invoke_i32( Runtime::ModuleInstance* instance, const char* name, I32 arg ) {
+   auto function = Runtime::asFunctionNullable( Runtime::getInstanceExport( instance, name ) );
+   FC_ASSERT( function, "missing export ${n}", ("n",name) );
+   return Runtime::invokeFunction( function, { Runtime::Value(arg) } ).i32;
+}
+
+const char* mix_wast = R"=====(
+(module
+  (memory 1)
+  (data (i32.const 16) "\07\00\00\00")
+  (func $mix (export "mix") (param $x i32) (result i32)
+    (i32.xor
+      (i32.add (i32.mul (get_local $x) (i32.const 31)) (i32.load (i32.const 16)))
+      (i32.shr_u (get_local $x) (i32.const 3))
+    )
+  )
+)
+)=====";
+
+const I32 mix_args[] = { 0, 1, 2, -7, 1000, 0x7fffffff };
+
+/// A handler which overwrites the initial data, writes zeroed memory, and grows the memory by two pages
+const char* dirty_wast = R"=====(
+(module
+  (memory 1)
+  (data (i32.const 8) "initial\00")
+  (func $dirty (export "dirty")
+    (i64.store (i32.const 8) (i64.const -1))
+    (i32.store8 (i32.const 100) (i32.const 1))
+    (drop (grow_memory (i32.const 2)))
+    (i32.store8 (i32.const 131077) (i32.const 1))
+  )
+)
+)=====";
+
+/// Exports one handler under names whose type and recipient contain '_', and others which name no handler
+const char* entry_points_wast = R"=====(
+(module
+  (memory 1)
+  (func $handler)
+  (export "onApply_set_value_my_contract" (func $handler))
+  (export "onValidate_Transfer_simplecoin" (func $handler))
+  (export "onPrecondition_nounderscore" (func $handler))
+  (export "onApply_aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa_toolong" (func $handler))
+  (export "onApply_memory_notafunction" (memory 0))
+  (export "onInit" (func $handler))
+)
+)=====";
+
+/// The runtime is initialized once per process, by the first use of the wasm interface
+struct wasm_runtime_fixture {
+   wasm_runtime_fixture() { wasm_interface::get(); }
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(wasm_tests, wasm_runtime_fixture)
+
+// Machine code loaded from the object cache behaves exactly like freshly compiled code
+BOOST_AUTO_TEST_CASE(object_cache_hit_matches_fresh_compile)
+{ try {
+   auto module = parse_wast( mix_wast );
+   auto fresh  = instantiate( module );
+
+   counting_object_cache cache;
+   auto stored = instantiate( module, &cache, "mix" );
+   BOOST_CHECK_EQUAL( cache.hits, 0 );
+   BOOST_CHECK_EQUAL( cache.stores, 1 );
+
+   auto cached = instantiate( module, &cache, "mix" );
+   BOOST_CHECK_EQUAL( cache.hits, 1 );
+   BOOST_CHECK_EQUAL( cache.stores, 1 );
+
+   // Code compiled ahead of time is only linked when the module is instantiated
+   counting_object_cache precompiled_cache;
+   Runtime::compileModule( module, &precompiled_cache, "mix" );
+   BOOST_CHECK_EQUAL( precompiled_cache.stores, 1 );
+   Runtime::compileModule( module, &precompiled_cache, "mix" );
+   BOOST_CHECK_EQUAL( precompiled_cache.stores, 1 );
+   auto precompiled = instantiate( module, &precompiled_cache, "mix" );
+   BOOST_CHECK_EQUAL( precompiled_cache.stores, 1 );
+
+   for( auto arg : mix_args ) {
+      auto expected = invoke_i32( fresh, "mix", arg );
+      BOOST_CHECK_EQUAL( invoke_i32( stored, "mix", arg ), expected );
+      BOOST_CHECK_EQUAL( invoke_i32( cached, "mix", arg ), expected );
+      BOOST_CHECK_EQUAL( invoke_i32( precompiled, "mix", arg ), expected );
+   }
+} FC_LOG_AND_RETHROW() }
+
+// Restoring a snapshot undoes whatever a handler wrote, and shrinks the memory back if the handler grew it
+BOOST_AUTO_TEST_CASE(memory_reset_after_handler)
+{ try {
+   auto module   = parse_wast( dirty_wast );
+   auto instance = instantiate( module );
+   auto dirty    = Runtime::asFunctionNullable( Runtime::getInstanceExport( instance, "dirty" ) );
+   BOOST_REQUIRE( dirty );
+
+   auto memory   = Runtime::getDefaultMemory( instance );
+   auto snapshot = Runtime::createMemorySnapshot( memory );
+   BOOST_REQUIRE( snapshot );
+
+   // Once the snapshot has been restored, later restores only discard the pages written since
+   for( uint32_t round = 0; round < 3; ++round ) {
+      Runtime::invokeNullaryFunction( dirty );
+      BOOST_CHECK_EQUAL( Runtime::getMemoryNumPages( memory ), 3 );
+      BOOST_CHECK_NE( std::string( &Runtime::memoryRef<char>( memory, 8 ) ), "initial" );
+      BOOST_CHECK_EQUAL( Runtime::memoryRef<char>( memory, 131077 ), 1 );
+
+      BOOST_REQUIRE( Runtime::restoreMemorySnapshot( memory, snapshot ) );
+      BOOST_CHECK_EQUAL( Runtime::getMemoryNumPages( memory ), 1 );
+      BOOST_CHECK_EQUAL( std::string( &Runtime::memoryRef<char>( memory, 8 ) ), "initial" );
+      BOOST_CHECK_EQUAL( Runtime::memoryRef<char>( memory, 100 ), 0 );
+   }
+
+   // The pages shrunk off the end are zeroed when the memory grows again
+   BOOST_CHECK_EQUAL( Runtime::growMemory( memory, 2 ), 1 );
+   BOOST_CHECK_EQUAL( Runtime::memoryRef<char>( memory, 131077 ), 0 );
+
+   Runtime::deleteMemorySnapshot( snapshot );
+} FC_LOG_AND_RETHROW() }
+
+// Handlers are found under every split of their name into a type and recipient, either of which may contain '_'
+BOOST_AUTO_TEST_CASE(find_entry_points_with_underscores)
+{ try {
+   auto module   = parse_wast( entry_points_wast );
+   auto instance = instantiate( module );
+   auto handler  = Runtime::asFunctionNullable( Runtime::getInstanceExport( instance, "onApply_set_value_my_contract" ) );
+   BOOST_REQUIRE( handler );
+
+   auto key = []( wasm_interface::entry_point phase, const std::string& type, const std::string& recipient ) {
+      return wasm_interface::entry_point_key{ phase, TypeName(type), AccountName(recipient) };
+   };
+   auto table = wasm_interface::find_entry_points( module, instance );
+   auto find  = [&]( const wasm_interface::entry_point_key& k ) -> Runtime::FunctionInstance* {
+      auto itr = table.find( k );
+      return itr == table.end() ? nullptr : itr->second;
+   };
+
+   BOOST_CHECK_EQUAL( table.size(), 4 );
+   BOOST_CHECK( find( key( wasm_interface::entry_point::apply, "set", "value_my_contract" ) ) == handler );
+   BOOST_CHECK( find( key( wasm_interface::entry_point::apply, "set_value", "my_contract" ) ) == handler );
+   BOOST_CHECK( find( key( wasm_interface::entry_point::apply, "set_value_my", "contract" ) ) == handler );
+   BOOST_CHECK( find( key( wasm_interface::entry_point::validate, "Transfer", "simplecoin" ) ) == handler );
+
+   // Only the phase the handler was exported for dispatches to it
+   BOOST_CHECK( !find( key( wasm_interface::entry_point::validate, "set_value", "my_contract" ) ) );
+   BOOST_CHECK( !find( key( wasm_interface::entry_point::apply, "Transfer", "simplecoin" ) ) );
+} FC_LOG_AND_RETHROW() }
+
+// Threads each instantiate the same module at once, sharing the machine code through the object cache
+BOOST_AUTO_TEST_CASE(threads_instantiate_same_code)
+{ try {
+   const auto module = parse_wast( mix_wast );
+   std::vector<I32> expected;
+   auto fresh = instantiate( module );
+   for( auto arg : mix_args )
+      expected.push_back( invoke_i32( fresh, "mix", arg ) );
+
+   counting_object_cache cache;
+   for( uint32_t round = 0; round < 4; ++round ) {
+      // Release both threads at once, so that they race to compile and link the code
+      std::promise<void> start;
+      std::shared_future<void> started = start.get_future().share();
+      std::vector<I32> results[2];
+      std::exception_ptr errors[2];
+
+      auto run = [&]( uint32_t index ) {
+         try {
+            started.wait();
+            auto instance = instantiate( module, &cache, "mix" );
+            for( auto arg : mix_args )
+               results[index].push_back( invoke_i32( instance, "mix", arg ) );
+         } catch( ... ) {
+            errors[index] = std::current_exception();
+         }
+      };
+      std::thread first( run, 0 ), second( run, 1 );
+      start.set_value();
+      first.join();
+      second.join();
+
+      for( uint32_t index = 0; index < 2; ++index ) {
+         if( errors[index] ) std::rethrow_exception( errors[index] );
+         BOOST_CHECK( results[index] == expected );
+      }
+   }
+   // Code generation is serialized, so the thread which lost the first race links the code the other one stored
+   BOOST_CHECK_EQUAL( cache.stores, 1 );
+   BOOST_CHECK_EQUAL( cache.hits, 7 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()